@@ -0,0 +1,37 @@
+#ifndef __ALARM_PUB_H__
+#define __ALARM_PUB_H__
+
+#include <stdint.h>
+
+#define ALARM_PUB_PAYLOAD_LEN   256
+#define ALARM_PUB_TOPIC_LEN     96
+#define ALARM_PUB_HIST_BUCKETS  8
+#define ALARM_PUB_HIST_STR_LEN  48      // 直方图上报字符串长度，每桶计数 4 位以内不截断
+
+/***********************************************************************
+* 结构体名称: alarm_pub_stats_t
+* 说    明: 告警发送统计。时延均从按键中断时刻算起：
+*           中断 -> 开始发送（消抖与任务调度），开始发送 -> 收到 PUBACK（网络往返）
+* 成    员: hist          - 中断到 PUBACK 的时延直方图，上限见 alarm_pub_hist_bound
+*           last_ms       - 最近一次告警的中断到 PUBACK 时延
+*           *_max_ms      - 各阶段最大时延
+************************************************************************/
+typedef struct
+{
+    uint32_t sent;
+    uint32_t failed;
+    uint32_t hist[ALARM_PUB_HIST_BUCKETS];
+    uint32_t last_ms;
+    uint32_t isr_to_pub_max_ms;
+    uint32_t pub_to_ack_max_ms;
+    uint32_t total_max_ms;
+} alarm_pub_stats_t;
+
+int alarm_pub_init(const char *device_id, const char *service_id);
+int alarm_pub_send(int fallen, uint32_t isr_ms, const int32_t *lat_e7, const int32_t *lon_e7);
+uint32_t alarm_pub_hist_bound(int bucket);
+int alarm_pub_format_hist(char *buf, int size);
+void alarm_pub_get_stats(alarm_pub_stats_t *stats);
+void alarm_pub_print_stats(void);
+
+#endif
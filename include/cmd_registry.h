@@ -0,0 +1,83 @@
+#ifndef __CMD_REGISTRY_H__
+#define __CMD_REGISTRY_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cJSON.h>
+
+#define CMD_REGISTRY_SLOTS      32      // 散列表槽数，2 的幂，不少于命令数的 2 倍
+#define CMD_ARGS_MAX            64      // 参数结构体的最大长度
+#define CMD_PARAM_STR_MAX       32      // 字符串参数的最大长度（含结尾 '\0'）
+
+/* 命令执行结果，作为命令响应的 result_code 返回平台 */
+#define CMD_RET_OK              0
+#define CMD_RET_FAIL            1       // 处理函数执行失败
+#define CMD_RET_UNKNOWN         2       // 未注册的命令
+#define CMD_RET_BAD_PARAM       3       // 参数缺失、类型不符或超出范围
+
+/***********************************************************************
+* 枚举类型: cmd_param_type_t
+* 说    明: 参数类型及其在参数结构体中的存储类型
+************************************************************************/
+typedef enum
+{
+    CMD_PARAM_INT = 0,      // JSON 数值，存为 int32_t，检查 [min, max]
+    CMD_PARAM_ONOFF,        // "ON" / "OFF"，存为 int32_t 1 / 0
+    CMD_PARAM_ENUM,         // 字符串，在 names 中的序号存为 int32_t
+    CMD_PARAM_STRING,       // 字符串，存为 char[CMD_PARAM_STR_MAX]
+} cmd_param_type_t;
+
+/***********************************************************************
+* 结构体名称: cmd_param_t
+* 说    明: 参数声明。offset 为参数在参数结构体中的偏移（offsetof）
+* 成    员: required    - 1 必填；0 可选，缺省时参数结构体中保持为 0
+*           names       - CMD_PARAM_ENUM 的取值表，以 NULL 结尾，比较时不区分大小写
+************************************************************************/
+typedef struct
+{
+    const char *name;
+    cmd_param_type_t type;
+    uint8_t required;
+    uint16_t offset;
+    int32_t min;
+    int32_t max;
+    const char *const *names;
+} cmd_param_t;
+
+/*
+ * 命令处理函数：args 为按声明校验、填写后的参数结构体，
+ * paras 为原始参数对象，供区域坐标等无法用定长参数描述的内容使用
+ */
+typedef int (*cmd_handler_t)(const void *args, const cJSON *paras);
+
+/***********************************************************************
+* 结构体名称: cmd_def_t
+* 说    明: 命令定义，由调用方静态定义后注册
+************************************************************************/
+typedef struct
+{
+    const char *name;
+    const cmd_param_t *params;
+    uint8_t param_count;
+    uint16_t args_size;
+    cmd_handler_t handler;
+} cmd_def_t;
+
+/***********************************************************************
+* 结构体名称: cmd_stats_t
+* 说    明: 单条命令的执行统计（校验与处理函数耗时）
+************************************************************************/
+typedef struct
+{
+    uint32_t count;
+    uint32_t failed;
+    uint32_t run_total_ms;
+    uint32_t run_max_ms;
+} cmd_stats_t;
+
+uint32_t cmd_registry_hash(const char *name);
+int cmd_registry_register(const cmd_def_t *def);
+int cmd_registry_dispatch(const char *name, const cJSON *paras);
+void cmd_registry_print_stats(void);
+
+#endif
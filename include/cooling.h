@@ -0,0 +1,43 @@
+#ifndef __COOLING_H__
+#define __COOLING_H__
+
+#include <stdint.h>
+
+#define COOLING_TASK_STACK      1024
+#define COOLING_TASK_PRIO       23      // 只做开关输出，低于主任务与采样任务
+
+// 开始 / 停止降温的体温、回差与心率阈值由参数表（param_store）提供，可由平台调整
+#define COOLING_HR_DUTY         50      // 心率过高时的最低占空比（%）
+
+#define COOLING_KP              60.0f   // 比例系数：每超出设定点 1°C 增加的占空比（%）
+#define COOLING_KI              0.5f    // 积分系数：每 °C·s 累积的占空比（%）
+
+#define COOLING_WINDOW_MS       10000   // 时间比例控制周期，每周期按占空比吸合一次继电器
+#define COOLING_MIN_SWITCH_MS   1000    // 继电器最短吸合 / 释放时间，短于该值的脉冲合并
+#define COOLING_LOAD_MW         1500    // 降温负载功率（毫瓦），用于估算能耗，按实际负载修改
+#define COOLING_LEVEL_AUTO      (-1)    // 由体温 / 心率自动控制
+
+/***********************************************************************
+* 结构体名称: cooling_stats_t
+* 说    明: 降温控制统计
+* 成    员: duty        - 当前控制周期的占空比（%）
+*           switches    - 继电器吸合次数
+*           on_ms       - 累计吸合时间
+*           energy_mwh  - 按 COOLING_LOAD_MW 估算的累计能耗
+************************************************************************/
+typedef struct
+{
+    int duty;
+    uint32_t switches;
+    uint32_t on_ms;
+    uint32_t energy_mwh;
+} cooling_stats_t;
+
+int cooling_init(void);
+void cooling_set_input(float temp_predict, int heart_rate);
+int cooling_set_level(int level);
+int cooling_get_level(void);
+void cooling_get_stats(cooling_stats_t *stats);
+void cooling_print_stats(void);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef __DEVICE_SHADOW_H__
+#define __DEVICE_SHADOW_H__
+
+#include <stdint.h>
+
+#define SHADOW_PROPS_MAX        32      // 属性个数上限，有效标志按位保存
+#define SHADOW_SERVICES_MAX     4       // 一次响应中的服务个数上限
+
+/***********************************************************************
+* 枚举类型: shadow_type_t
+* 说    明: 影子属性类型，决定保存格式与响应时的 JSON 格式
+************************************************************************/
+typedef enum
+{
+    SHADOW_TYPE_INT = 0,
+    SHADOW_TYPE_FLOAT,
+    SHADOW_TYPE_E7,         // 1e-7 度的整数经纬度，响应时按小数输出
+    SHADOW_TYPE_ENUM,       // 整数取值，响应时按 names 输出字符串
+} shadow_type_t;
+
+/***********************************************************************
+* 结构体名称: shadow_def_t
+* 说    明: 影子属性定义，属性序号即在定义表中的下标
+* 成    员: names   - SHADOW_TYPE_ENUM 各取值的字符串，以 NULL 结尾，其他类型为 NULL
+************************************************************************/
+typedef struct
+{
+    const char *service_id;
+    const char *key;
+    shadow_type_t type;
+    const char *const *names;
+} shadow_def_t;
+
+typedef union
+{
+    int32_t i;
+    float f;
+} shadow_value_t;
+
+/***********************************************************************
+* 结构体名称: shadow_stats_t
+* 说    明: 影子统计
+* 成    员: updates         - 更新次数
+*           gets            - 收到的查询次数
+*           answered        - 成功响应的次数
+*           no_match        - 请求的服务不存在或尚无数据的次数
+*           copy_max_us     - 查询时拷贝影子的最长耗时（持锁时间，微秒）
+*           get_max_ms      - 查询到收到响应 PUBACK 的最长耗时
+************************************************************************/
+typedef struct
+{
+    uint32_t updates;
+    uint32_t gets;
+    uint32_t answered;
+    uint32_t no_match;
+    uint32_t copy_max_us;
+    uint32_t get_max_ms;
+} shadow_stats_t;
+
+int device_shadow_init(const shadow_def_t *defs, uint8_t count);
+void device_shadow_update(uint8_t id, const shadow_value_t *values, uint8_t count);
+void device_shadow_set_int(uint8_t id, int32_t value);
+void device_shadow_set_float(uint8_t id, float value);
+int device_shadow_respond(char *request_id, const char *service_id);
+void device_shadow_get_stats(shadow_stats_t *stats);
+void device_shadow_print_stats(void);
+
+#endif
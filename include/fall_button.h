@@ -0,0 +1,32 @@
+#ifndef __FALL_BUTTON_H__
+#define __FALL_BUTTON_H__
+
+#include <stdint.h>
+
+#define FALL_BUTTON_TASK_STACK      2048
+#define FALL_BUTTON_TASK_PRIO       27      // 高于采样与串口任务，告警尽快进入发送通道
+#define FALL_BUTTON_DEBOUNCE_MS     30      // 按键抖动稳定时间，之后复核电平
+
+/*
+ * 摔倒 / 恢复回调，在按键任务中执行。
+ * fallen：1 摔倒（F1），0 恢复（F2）；isr_ms：触发中断时的时间戳
+ */
+typedef void (*fall_button_cb_t)(int fallen, uint32_t isr_ms, void *arg);
+
+/***********************************************************************
+* 结构体名称: fall_button_stats_t
+* 说    明: 按键中断与消抖统计
+************************************************************************/
+typedef struct
+{
+    uint32_t isr_count;     // 中断次数（含抖动）
+    uint32_t bounces;       // 复核电平时已释放、被判为抖动的次数
+    uint32_t repeats;       // 状态未变化（重复按下）的次数
+    uint32_t events;        // 产生的摔倒 / 恢复事件数
+} fall_button_stats_t;
+
+int fall_button_init(fall_button_cb_t cb, void *arg);
+int fall_button_is_fallen(void);
+void fall_button_get_stats(fall_button_stats_t *stats);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __GEOFENCE_H__
+#define __GEOFENCE_H__
+
+#include <stdint.h>
+
+#define GEOFENCE_MAX_ZONES          16
+#define GEOFENCE_MAX_VERTICES       12
+#define GEOFENCE_NAME_LEN           16
+#define GEOFENCE_DEFAULT_DWELL_S    300     // 区域内停留多久触发 dwell 事件
+#define GEOFENCE_DEBOUNCE           2       // 连续多少次判定一致才切换进出状态，抑制边界抖动
+
+/***********************************************************************
+* 枚举类型: geofence_shape_t
+* 说    明: 区域形状
+************************************************************************/
+typedef enum
+{
+    GEOFENCE_CIRCLE = 0,
+    GEOFENCE_POLYGON,
+} geofence_shape_t;
+
+/***********************************************************************
+* 枚举类型: geofence_event_type_t
+* 说    明: 区域事件类型
+************************************************************************/
+typedef enum
+{
+    GEOFENCE_EVT_ENTER = 0,
+    GEOFENCE_EVT_EXIT,
+    GEOFENCE_EVT_DWELL,
+} geofence_event_type_t;
+
+/***********************************************************************
+* 结构体名称: geofence_zone_def_t
+* 说    明: 区域定义（编译期表或云端命令下发）
+* 成    员: id          - 区域编号，非 0，重复下发时覆盖
+*           name        - 区域名称，如 "site"、"hazard-1"、"cooling-A"
+*           shape       - 形状
+*           dwell_s     - 停留事件阈值（秒），0 表示使用默认值
+*           lat_e7 / lon_e7 - 圆心（圆形）或各顶点（多边形），1e-7 度
+*           count       - 多边形顶点数
+*           radius_m    - 半径（米，圆形）
+************************************************************************/
+typedef struct
+{
+    uint16_t id;
+    char name[GEOFENCE_NAME_LEN];
+    uint8_t shape;
+    uint16_t dwell_s;
+    int32_t lat_e7[GEOFENCE_MAX_VERTICES];
+    int32_t lon_e7[GEOFENCE_MAX_VERTICES];
+    uint8_t count;
+    uint32_t radius_m;
+} geofence_zone_def_t;
+
+/***********************************************************************
+* 结构体名称: geofence_event_t
+* 说    明: 区域事件
+************************************************************************/
+typedef struct
+{
+    uint16_t zone_id;
+    uint8_t type;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t dwell_s;   // 事件发生时已在区域内停留的时长（EXIT / DWELL）
+    uint32_t time_ms;   // 事件发生时的时间戳，用于换算 event_time
+} geofence_event_t;
+
+typedef void (*geofence_event_cb_t)(const geofence_event_t *evt, void *arg);
+
+int geofence_init(geofence_event_cb_t cb, void *arg);
+int geofence_add(const geofence_zone_def_t *def);
+int geofence_remove(uint16_t id);
+int geofence_count(void);
+void geofence_update(int32_t lat_e7, int32_t lon_e7, uint32_t now_ms);
+const char *geofence_event_name(uint8_t type);
+
+#endif
@@ -2,14 +2,39 @@
 #define __GPS_H__
 
 #include <stdint.h>
+#include "nmea_parser.h"
+#include "gps_filter.h"
 
-#define UART_BUFF_SIZE 1024
-#define U_SLEEP_TIME   700000
+#define UART_BUFF_SIZE      256
+#define GPS_DEFAULT_BAUD    9600    // GPS 模块出厂默认波特率
+#define GPS_TASK_STACK_SIZE 2048
+#define GPS_TASK_PRIO       25
+#define GPS_FIX_MAX_AGE_MS  5000    // 快照超过该时长未更新视为定位丢失
+
+/***********************************************************************
+* 结构体名称: gps_snapshot_t
+* 说    明: GPS 任务发布的最新定位快照
+* 成    员: fix      - 最近一次通过筛选的综合定位记录
+*           fix_ms   - 获得该定位时的毫秒时间戳
+*           track    - 卡尔曼滤波后的位置、速度与航向，GPS 任务每轮外推到当前时刻
+*           age_ms   - 读取时距该定位的时长（毫秒）
+*           quality  - 最近一条 GGA 的定位质量（反映当前接收状况）
+*           valid    - 是否曾获得过有效定位
+************************************************************************/
+typedef struct
+{
+    nmea_fix_t fix;
+    uint32_t fix_ms;
+    gps_track_t track;
+    uint32_t age_ms;
+    uint8_t quality;
+    uint8_t valid;
+} gps_snapshot_t;
 
 void Uart1GpioInit(void);
-void Uart1Config(void);
-double dm_to_dd(double dm);
-void RunGPS(double *lat, double *lon);
+void Uart1Config(uint32_t baud_rate);
+int gps_get_snapshot(gps_snapshot_t *out);
+void gps_print_stats(void);
 void UartExampleEntry(void);
 
 #endif
@@ -0,0 +1,46 @@
+#ifndef __GPS_AIDING_H__
+#define __GPS_AIDING_H__
+
+#include <stdint.h>
+#include "gps.h"
+
+#define GPS_AIDING_SAVE_INTERVAL_MS (10 * 60 * 1000)   // 定位期间写 flash 的最短间隔
+#define GPS_AIDING_POS_ACC_M        3000    // 注入位置的精度估计（米），班次间设备可能被带离现场
+#define GPS_AIDING_TIME_ACC_S       2       // 注入时间的精度估计（秒），只在 SNTP 等校时后注入
+
+/***********************************************************************
+* 结构体名称: gps_aiding_rec_t
+* 说    明: 掉电保存的最近一次有效定位
+* 成    员: utc_date  - ddmmyy
+*           utc_time  - hhmmss
+*           lat_e7 / lon_e7 - 纬度 / 经度（1e-7 度）
+*           alt_dm    - 海拔（0.1 米）
+************************************************************************/
+typedef struct
+{
+    uint32_t utc_date;
+    uint32_t utc_time;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    int32_t alt_dm;
+} gps_aiding_rec_t;
+
+/***********************************************************************
+* 结构体名称: gps_ttff_t
+* 说    明: 本次上电的首次定位时间
+* 成    员: ttff_ms - 上电到首次有效定位的毫秒数，尚未定位时为 0
+*           aided   - 启动时是否注入了辅助数据
+*           fixed   - 是否已获得首次定位
+************************************************************************/
+typedef struct
+{
+    uint32_t ttff_ms;
+    uint8_t aided;
+    uint8_t fixed;
+} gps_ttff_t;
+
+int gps_aiding_inject(void);
+void gps_aiding_poll(const gps_snapshot_t *snap, uint32_t now_ms);
+void gps_aiding_get_ttff(gps_ttff_t *ttff);
+
+#endif
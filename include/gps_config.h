@@ -0,0 +1,70 @@
+#ifndef __GPS_CONFIG_H__
+#define __GPS_CONFIG_H__
+
+#include <stdint.h>
+#include "nmea_parser.h"
+
+/***********************************************************************
+* 枚举类型: gps_cfg_profile_t
+* 说    明: GPS 接收机配置命令集
+************************************************************************/
+typedef enum
+{
+    GPS_CFG_PROFILE_NONE = 0,   // 不发送任何配置，保持模块默认
+    GPS_CFG_PROFILE_PMTK,       // MediaTek PMTK 命令（$PMTKxxx）
+    GPS_CFG_PROFILE_UBX,        // u-blox UBX 二进制协议
+} gps_cfg_profile_t;
+
+// 编译期默认配置，可在 BUILD.gn 的 defines 中覆盖
+#ifndef GPS_CFG_PROFILE
+#define GPS_CFG_PROFILE         GPS_CFG_PROFILE_PMTK
+#endif
+#ifndef GPS_CFG_BAUD
+#define GPS_CFG_BAUD            115200
+#endif
+#ifndef GPS_CFG_RATE_MS
+#define GPS_CFG_RATE_MS         1000    // 定位输出间隔，100(10Hz) ~ 1000(1Hz) 或更长
+#endif
+
+#define GPS_CFG_ACK_TIMEOUT_MS      1000
+#define GPS_CFG_VERIFY_TIMEOUT_MS   2500    // 切换波特率后等待合法语句的时长
+#define GPS_CFG_MIN_FAST_BAUD       38400   // 低于该波特率时不允许高于 1Hz 的输出
+
+/***********************************************************************
+* 结构体名称: gps_cfg_t
+* 说    明: 接收机配置参数
+* 成    员: profile   - 命令集
+*           baud_rate - 目标波特率
+*           rate_ms   - 定位输出间隔（毫秒）
+************************************************************************/
+typedef struct
+{
+    gps_cfg_profile_t profile;
+    uint32_t baud_rate;
+    uint16_t rate_ms;
+} gps_cfg_t;
+
+/***********************************************************************
+* 结构体名称: gps_cfg_result_t
+* 说    明: 配置结果，各项为 1 表示已收到 ACK 或已验证
+************************************************************************/
+typedef struct
+{
+    uint8_t mask_ok;
+    uint8_t baud_ok;
+    uint8_t rate_ok;
+    uint32_t link_baud;
+    uint16_t rate_ms;
+} gps_cfg_result_t;
+
+void gps_config_get_default(gps_cfg_t *cfg);
+int gps_config_apply(const gps_cfg_t *cfg, nmea_parser_t *parser, gps_cfg_result_t *result);
+void gps_config_request(const gps_cfg_t *cfg);
+int gps_config_take_request(gps_cfg_t *cfg);
+gps_cfg_profile_t gps_config_profile(void);
+int gps_config_send_nmea(const char *body);
+int gps_config_send_ubx(uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len);
+int gps_config_wait_pmtk_ack(int cmd, nmea_parser_t *parser, uint32_t timeout_ms);
+int gps_config_wait_ubx_ack(uint8_t cls, uint8_t id, nmea_parser_t *parser, uint32_t timeout_ms);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef __GPS_FILTER_H__
+#define __GPS_FILTER_H__
+
+#include <stdint.h>
+#include "nmea_parser.h"
+
+#define GPS_FILTER_ACCEL_SIGMA     1.5f     // 过程噪声：未建模加速度标准差（m/s²），步行/搬运
+#define GPS_FILTER_UERE_M          4.0f     // 用户等效测距误差（米），HDOP 乘以该值得到水平误差
+#define GPS_FILTER_MIN_HDOP        0.8f
+#define GPS_FILTER_GOOD_SATS       7        // 卫星数低于该值时按比例放大测量噪声
+#define GPS_FILTER_GATE_CHI2       11.8f    // 二维新息门限（卡方 2 自由度，约 99.7%）
+#define GPS_FILTER_MAX_SPEED_MS    20.0f    // 相对上次接受位置的隐含速度上限（m/s）
+#define GPS_FILTER_MAX_REJECTS     5        // 连续被拒绝次数达到该值时认为滤波器失锁，重新初始化
+#define GPS_FILTER_TRACK_MS        2500     // 距上次测量超过该时间即视为外推状态
+#define GPS_FILTER_COAST_MS        10000    // 定位中断后按匀速外推的最长时间
+
+/***********************************************************************
+* 枚举类型: gps_track_state_t
+* 说    明: 滤波输出状态
+************************************************************************/
+typedef enum
+{
+    GPS_TRACK_NONE = 0,     // 无有效轨迹
+    GPS_TRACK_TRACKING,     // 正常跟踪
+    GPS_TRACK_COASTING,     // 定位中断，按匀速外推
+} gps_track_state_t;
+
+/***********************************************************************
+* 结构体名称: gps_track_t
+* 说    明: 滤波后的位置、速度与航向
+* 成    员: lat_e7 / lon_e7 - 纬度 / 经度（1e-7 度）
+*           speed_ms  - 对地速度（m/s）
+*           heading   - 航向（度，正北为 0，顺时针）
+*           pos_std_m - 位置标准差估计（米）
+*           state     - 输出状态
+************************************************************************/
+typedef struct
+{
+    int32_t lat_e7;
+    int32_t lon_e7;
+    float speed_ms;
+    float heading;
+    float pos_std_m;
+    uint8_t state;
+} gps_track_t;
+
+/***********************************************************************
+* 结构体名称: gps_filter_t
+* 说    明: 匀速模型卡尔曼滤波器。以首个定位为原点建立局部东-北坐标（米），
+*           东、北两轴模型与噪声相同，共用一个 2x2 协方差矩阵
+* 成    员: lat0_e7 / lon0_e7 - 局部坐标原点
+*           m_per_e7_lon      - 原点纬度处经度 1e-7 度对应的米数
+*           e / n / ve / vn   - 位置（米）与速度（m/s）
+*           p00 / p01 / p11   - 单轴协方差（位置、位置-速度、速度）
+*           last_ms           - 上次接受测量的时间戳
+*           rejects           - 连续被拒绝的测量数
+*           accepted / rejected - 累计接受 / 拒绝的测量数
+*           initialized       - 是否已初始化
+************************************************************************/
+typedef struct
+{
+    int32_t lat0_e7;
+    int32_t lon0_e7;
+    float m_per_e7_lon;
+    float e;
+    float n;
+    float ve;
+    float vn;
+    float p00;
+    float p01;
+    float p11;
+    uint32_t last_ms;
+    uint16_t rejects;
+    uint32_t accepted;
+    uint32_t rejected;
+    int initialized;
+} gps_filter_t;
+
+void gps_filter_init(gps_filter_t *f);
+int gps_filter_update(gps_filter_t *f, const nmea_fix_t *fix, uint32_t now_ms);
+void gps_filter_output(const gps_filter_t *f, uint32_t now_ms, gps_track_t *out);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef __GPS_POWER_H__
+#define __GPS_POWER_H__
+
+#include <stdint.h>
+#include "gps.h"
+
+#define GPS_PWR_STILL_SPEED_KMH     1.0f    // 低于该速度视为静止
+#define GPS_PWR_MOVE_SPEED_KMH      3.0f    // 周期模式下高于该速度视为开始移动
+#define GPS_PWR_STILL_RADIUS_M      15.0f   // 位置偏离锚点超过该距离视为移动
+#define GPS_PWR_PERIODIC_AFTER_MS   (2 * 60 * 1000)     // 静止多久后进入周期模式
+#define GPS_PWR_STANDBY_AFTER_MS    (10 * 60 * 1000)    // 静止多久后进入待机
+#define GPS_PWR_WAKE_INTERVAL_MS    (5 * 60 * 1000)     // 待机时定时唤醒刷新位置的间隔
+#define GPS_PWR_REFRESH_MS          (60 * 1000)         // 定时唤醒后仍静止多久再次待机
+#define GPS_PWR_REFRESH_MAX_MS      (3 * 60 * 1000)     // 定时唤醒后一直无法定位时，最多搜索多久再次待机
+#define GPS_PWR_ACTIVITY_HR         90      // 心率高于该值视为佩戴者在活动，立即唤醒
+
+/***********************************************************************
+* 枚举类型: gps_power_mode_t
+* 说    明: GPS 接收机工作模式
+************************************************************************/
+typedef enum
+{
+    GPS_PWR_ACTIVE = 0,     // 连续定位
+    GPS_PWR_PERIODIC,       // 周期定位（PMTK225 / UBX 省电模式）
+    GPS_PWR_STANDBY,        // 待机（PMTK161 / UBX-RXM-PMREQ）
+    GPS_PWR_MODE_MAX,
+} gps_power_mode_t;
+
+/***********************************************************************
+* 结构体名称: gps_power_stats_t
+* 说    明: 各模式累计驻留时间与切换次数
+************************************************************************/
+typedef struct
+{
+    gps_power_mode_t mode;
+    uint32_t residency_ms[GPS_PWR_MODE_MAX];
+    uint32_t transitions;
+} gps_power_stats_t;
+
+void gps_power_init(uint32_t now_ms);
+void gps_power_poll(const gps_snapshot_t *snap, uint32_t now_ms);
+void gps_power_notify_activity(void);
+void gps_power_get_stats(gps_power_stats_t *stats);
+void gps_power_print_stats(void);
+
+#endif
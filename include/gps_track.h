@@ -0,0 +1,38 @@
+#ifndef __GPS_TRACK_H__
+#define __GPS_TRACK_H__
+
+#include <stdint.h>
+
+#define GPS_TRACK_TOLERANCE_M   5.0f    // 简化误差上限：被省略的点到保留折线的最大距离（米）
+#define GPS_TRACK_WINDOW        32      // 滑动窗口最多缓存的候选点数
+#define GPS_TRACK_SEG_BYTES     384     // 单个轨迹段的编码缓存
+#define GPS_TRACK_UPLOAD_MS     (5 * 60 * 1000)     // 轨迹段上传间隔
+#define GPS_TRACK_B64_SIZE      (((GPS_TRACK_SEG_BYTES + 2) / 3) * 4 + 1)
+
+/*
+ * 轨迹段编码（上传前整体做 base64）：
+ *   头部：版本(1 字节，=1)、UTC 日期 ddmmyy、UTC 时间 hhmmss、起点纬度、起点经度
+ *   各点：与上一点的秒差、纬度差、经度差
+ * 无符号数为 LEB128 变长整数，有符号数先做 zigzag 再按变长整数编码，坐标单位 1e-6 度。
+ */
+
+/***********************************************************************
+* 结构体名称: gps_track_stats_t
+* 说    明: 轨迹压缩统计
+************************************************************************/
+typedef struct
+{
+    uint32_t points_in;         // 输入的定位点数
+    uint32_t points_kept;       // 简化后保留的点数
+    uint32_t points_dropped;    // 轨迹段缓存已满时丢弃的点数
+    uint32_t segments;          // 已确认上传的轨迹段数
+} gps_track_stats_t;
+
+int gps_track_init(void);
+void gps_track_add(int32_t lat_e7, int32_t lon_e7, uint32_t now_ms, uint32_t utc_date, uint32_t utc_time);
+int gps_track_due(uint32_t now_ms);
+int gps_track_encode(char *out, int out_len, uint32_t now_ms);
+void gps_track_commit(uint32_t now_ms);
+void gps_track_get_stats(gps_track_stats_t *stats);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef __GPS_UART_H__
+#define __GPS_UART_H__
+
+#include <stdint.h>
+
+#define GPS_UART_RING_SIZE      2048    // 必须为 2 的幂
+#define GPS_UART_CHUNK_SIZE     64      // 接收任务单次从驱动取出的最大字节数
+#define GPS_UART_TASK_STACK     1024
+#define GPS_UART_TASK_PRIO      26
+
+/***********************************************************************
+* 结构体名称: gps_uart_stats_t
+* 说    明: GPS 串口接收统计
+* 成    员: rx_bytes      - 写入环形缓冲的总字节数
+*           rx_bursts     - 驱动返回的数据块数（每次线路空闲唤醒一次）
+*           ring_overruns - 环形缓冲满而丢弃的字节数（仅软件环形缓冲；hi_uart 不报告
+*                           硬件 FIFO 与驱动接收缓冲的溢出，这类丢字节表现为 NMEA 校验错误）
+*           read_errors   - 驱动读错误次数
+*           ring_peak     - 环形缓冲历史最高占用
+************************************************************************/
+typedef struct
+{
+    uint32_t rx_bytes;
+    uint32_t rx_bursts;
+    uint32_t ring_overruns;
+    uint32_t read_errors;
+    uint32_t ring_peak;
+} gps_uart_stats_t;
+
+int gps_uart_start(void);
+int gps_uart_set_baud(uint32_t baud_rate);
+uint32_t gps_uart_get_baud(void);
+int gps_uart_read(uint8_t *buf, int len, uint32_t timeout_ms);
+int gps_uart_write(const uint8_t *buf, int len);
+void gps_uart_get_stats(gps_uart_stats_t *stats);
+void gps_uart_print_stats(void);
+
+#endif
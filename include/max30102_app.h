@@ -22,5 +22,7 @@ void max30102_Init(void);
 void max30102_Read_FIFO(u32 *red_led, u32 *ir_led);
 void cir_hs(void);
 void max30102_app_entry(void);
+void max30102_app_setup(void);
+void max30102_app_sample(void);
 
 #endif
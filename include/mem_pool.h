@@ -0,0 +1,35 @@
+#ifndef __MEM_POOL_H__
+#define __MEM_POOL_H__
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+
+/***********************************************************************
+* 结构体名称: mem_pool_t
+* 说    明: 定长块内存池，块由调用方以静态数组提供，空闲块通过块首的指针串成链表。
+*           任务间可并发使用，不可在中断中调用
+* 成    员: block_size  - 块大小，至少一个指针长度且按指针对齐
+*           count       - 块总数
+*           in_use      - 当前已分配的块数
+*           peak        - 已分配块数的峰值
+*           alloc_fail  - 池耗尽导致分配失败的次数
+************************************************************************/
+typedef struct
+{
+    uint8_t *base;
+    void *free_head;
+    osMutexId_t mutex;
+    osSemaphoreId_t free_sem;   // 空闲块计数，供等待分配使用
+    uint16_t block_size;
+    uint16_t count;
+    uint16_t in_use;
+    uint16_t peak;
+    uint32_t alloc_fail;
+} mem_pool_t;
+
+int mem_pool_init(mem_pool_t *pool, void *base, uint16_t block_size, uint16_t count);
+void *mem_pool_alloc(mem_pool_t *pool);
+void *mem_pool_alloc_timeout(mem_pool_t *pool, uint32_t timeout);
+void mem_pool_free(mem_pool_t *pool, void *block);
+
+#endif
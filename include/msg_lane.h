@@ -0,0 +1,47 @@
+#ifndef __MSG_LANE_H__
+#define __MSG_LANE_H__
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+
+#define MSG_LANE_MAX_DEPTH      16
+
+/*
+ * 合并函数：把新消息 msg 合并进仍在队列中的 queued，成功返回 1，
+ * 两者不能合并（如类型不同）返回 0
+ */
+typedef int (*msg_lane_merge_t)(void *queued, const void *msg);
+
+/***********************************************************************
+* 结构体名称: msg_lane_t
+* 说    明: 单个优先级通道，先进先出的消息指针环形队列，任务间可并发使用
+* 成    员: depth_peak      - 队列深度峰值
+*           posted          - 入队次数
+*           coalesced       - 队列满时合并进已有消息的次数
+*           dropped         - 队列满且无法合并而丢弃的次数
+*           latency_*       - 入队到取出的等待时间
+************************************************************************/
+typedef struct
+{
+    const char *name;
+    void *slots[MSG_LANE_MAX_DEPTH];
+    uint32_t post_ms[MSG_LANE_MAX_DEPTH];
+    osMutexId_t mutex;
+    uint8_t capacity;
+    uint8_t head;
+    uint8_t count;
+    uint8_t depth_peak;
+    uint32_t posted;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t taken;
+    uint32_t latency_total_ms;
+    uint32_t latency_max_ms;
+} msg_lane_t;
+
+int msg_lane_init(msg_lane_t *lane, const char *name, uint8_t capacity);
+int msg_lane_put(msg_lane_t *lane, void *msg, msg_lane_merge_t merge);
+void *msg_lane_get(msg_lane_t *lane);
+void msg_lane_print_stats(const msg_lane_t *lane);
+
+#endif
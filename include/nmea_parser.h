@@ -0,0 +1,116 @@
+#ifndef __NMEA_PARSER_H__
+#define __NMEA_PARSER_H__
+
+#include <stdint.h>
+
+#define NMEA_MAX_SENTENCE   96      // NMEA 0183 规定单句不超过 82 字节，留出余量
+#define NMEA_MAX_FIELDS     24
+#define NMEA_GSV_SYSTEMS    4       // GP / GL / GA / BD(GB) 各自独立的 GSV 周期
+
+/***********************************************************************
+* 枚举类型: nmea_sentence_t
+* 说    明: 已识别的语句类型，随回调一起给出，表明本次更新了哪些字段
+************************************************************************/
+typedef enum
+{
+    NMEA_SENTENCE_GGA = 0,
+    NMEA_SENTENCE_RMC,
+    NMEA_SENTENCE_VTG,
+    NMEA_SENTENCE_GSA,
+    NMEA_SENTENCE_GSV,
+} nmea_sentence_t;
+
+/***********************************************************************
+* 结构体名称: nmea_fix_t
+* 说    明: 由 GGA/RMC/VTG/GSA/GSV 共同填充的综合定位记录
+* 成    员: utc_time     - UTC 时间，hhmmss 形式的整数（GGA/RMC）
+*           utc_date     - UTC 日期，ddmmyy 形式的整数（RMC）
+*           lat_e7 / lon_e7 - 纬度 / 经度（1e-7 度），南纬、西经为负
+*           altitude     - 海拔（米，GGA）
+*           speed_kmh    - 对地速度（km/h，RMC/VTG）
+*           course       - 对地航向（度，RMC/VTG）
+*           hdop / pdop / vdop - 精度因子（GGA/GSA）
+*           quality      - GGA 定位质量（0 无效，1 GPS，2 差分 ...）
+*           fix_mode     - GSA 定位模式（1 未定位，2 二维，3 三维）
+*           satellites   - 参与解算的卫星数（GGA）
+*           sats_in_view - 可见卫星总数（GSV，各系统求和）
+*           snr_max      - 可见卫星最大载噪比（dB-Hz，GSV）
+*           snr_avg      - 可见卫星平均载噪比（dB-Hz，GSV）
+*           rmc_valid    - RMC 状态位为 'A'
+************************************************************************/
+typedef struct
+{
+    uint32_t utc_time;
+    uint32_t utc_date;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    float altitude;
+    float speed_kmh;
+    float course;
+    float hdop;
+    float pdop;
+    float vdop;
+    uint8_t quality;
+    uint8_t fix_mode;
+    uint8_t satellites;
+    uint8_t sats_in_view;
+    uint8_t snr_max;
+    uint8_t snr_avg;
+    uint8_t rmc_valid;
+} nmea_fix_t;
+
+typedef void (*nmea_fix_cb_t)(const nmea_fix_t *fix, nmea_sentence_t type, void *arg);
+
+/***********************************************************************
+* 结构体名称: nmea_gsv_acc_t
+* 说    明: 单个卫星系统 GSV 周期内的累加值
+************************************************************************/
+typedef struct
+{
+    uint8_t in_view;
+    uint8_t snr_max;
+    uint8_t snr_count;
+    uint16_t snr_sum;
+} nmea_gsv_acc_t;
+
+/***********************************************************************
+* 结构体名称: nmea_parser_t
+* 说    明: 增量式 NMEA 解析器状态，跨多次串口读取保持
+* 成    员: buf          - 当前语句缓存，逗号在接收时原地替换为 '\0'
+*           len          - 当前语句已接收字节数
+*           state        - 状态机状态
+*           field_count  - 当前语句已切分的字段数
+*           field        - 各字段在 buf 中的起始偏移
+*           checksum     - '$' 与 '*' 之间字节的累计异或
+*           rx_checksum  - '*' 之后收到的校验值
+*           rx_digits    - '*' 之后收到的十六进制位数
+*           fix          - 综合定位记录
+*           gsv          - 各卫星系统当前 GSV 周期累加值
+*           sentences    - 校验通过的语句数
+*           checksum_errors - 校验失败或缺少校验的语句数
+*           overflows    - 超长被丢弃的语句数
+************************************************************************/
+typedef struct
+{
+    char buf[NMEA_MAX_SENTENCE + 1];
+    uint8_t len;
+    uint8_t state;
+    uint8_t field_count;
+    uint8_t field[NMEA_MAX_FIELDS];
+    uint8_t checksum;
+    uint8_t rx_checksum;
+    uint8_t rx_digits;
+    nmea_fix_t fix;
+    nmea_gsv_acc_t gsv[NMEA_GSV_SYSTEMS];
+    nmea_fix_cb_t cb;
+    void *cb_arg;
+    uint32_t sentences;
+    uint32_t checksum_errors;
+    uint32_t overflows;
+} nmea_parser_t;
+
+void nmea_parser_init(nmea_parser_t *p, nmea_fix_cb_t cb, void *arg);
+void nmea_parser_feed(nmea_parser_t *p, const uint8_t *data, int len);
+int nmea_format_e7(int32_t value, char *buf, int len);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __NV_STORE_H__
+#define __NV_STORE_H__
+
+#include <stdint.h>
+
+// 保留给应用的两个 flash 扇区，位于 2MB 布局的用户保留区（HI_FLASH_PARTITON_USR_RESERVE），
+// 由 BUILD.gn 的 defines 按板级分区表给出；nv_store_init 会对照分区表检查不与其他分区重叠
+#ifndef NV_STORE_FLASH_BASE
+#define NV_STORE_FLASH_BASE     0x001F8000
+#endif
+#define NV_STORE_SECTOR_SIZE    0x1000
+#define NV_STORE_MAX_LEN        128     // 单条记录数据的最大长度
+
+/***********************************************************************
+* 枚举类型: nv_key_t
+* 说    明: 掉电保存的数据项，取值写入 flash，已有取值不可修改含义
+************************************************************************/
+typedef enum
+{
+    NV_KEY_GPS_AIDING = 1,      // 最近一次有效定位与 UTC 时间
+    NV_KEY_PARAMS = 2,          // 平台下发的可调参数集
+    NV_KEY_MAX = 8,
+} nv_key_t;
+
+int nv_store_init(void);
+int nv_store_read(nv_key_t key, void *buf, uint16_t len);
+int nv_store_write(nv_key_t key, const void *data, uint16_t len);
+
+#endif
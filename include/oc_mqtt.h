@@ -85,6 +85,7 @@ typedef enum
     EN_OC_MQTT_PROFILE_VALUE_LONG,
     EN_OC_MQTT_PROFILE_VALUE_FLOAT,
     EN_OC_MQTT_PROFILE_VALUE_STRING,           ///< must be ended with '\0'
+    EN_OC_MQTT_PROFILE_VALUE_E7,               ///< int32_t in units of 1e-7, sent as a JSON number
     EN_OC_MQTT_PROFILE_VALUE_LAST,
 }en_oc_profile_data_t;
 
@@ -177,6 +178,14 @@ void device_info_init(char *client_id, char * username, char *password);
 
 void oc_set_cmd_rsp_cb(void (*cmd_rsp_cb)(uint8_t *recv_data, uint32_t recv_size, uint8_t **resp_data, uint32_t *resp_size));
 
+void oc_set_profile_rcv_cb(fn_oc_mqtt_profile_rcvdeal rcvfunc);
+
+void oc_set_conn_cb(void (*conn_cb)(int connected));
+
+int oc_mqtt_is_connected(void);
+
+int oc_mqtt_reconnect(void);
+
 int oc_mqtt_publish(char  *topic,uint8_t *msg,int msg_len,int qos);
 /**
  * @brief: use this function to send data to the platform without profile decode
@@ -0,0 +1,40 @@
+#ifndef __PARAM_STORE_H__
+#define __PARAM_STORE_H__
+
+#include <stdint.h>
+
+/***********************************************************************
+* 枚举类型: param_id_t
+* 说    明: 可由平台调整的参数，按序号保存在 flash 中，只能在末尾追加
+************************************************************************/
+typedef enum
+{
+    PARAM_COOLING_TEMP_ON = 0,  // 预测体温高于该值开始降温（°C）
+    PARAM_COOLING_TEMP_HYST,    // 停止降温的回差（°C）
+    PARAM_COOLING_HR_ON,        // 心率高于该值开始降温
+    PARAM_HRV_BASELINE_HR,      // 情绪估计的静息心率基线
+    PARAM_REPORT_PERIOD,        // 属性上报周期（秒）
+    PARAM_MAX,
+} param_id_t;
+
+typedef enum
+{
+    PARAM_TYPE_INT = 0,
+    PARAM_TYPE_FLOAT,
+} param_type_t;
+
+/* 参数生效回调，在提交修改的任务中执行，每个变化的参数调用一次 */
+typedef void (*param_change_cb_t)(param_id_t id);
+
+int param_store_init(param_change_cb_t cb);
+int32_t param_get_int(param_id_t id);
+float param_get_float(param_id_t id);
+uint32_t param_store_version(void);
+const char *param_store_name(param_id_t id);
+param_type_t param_store_type(param_id_t id);
+
+void param_store_begin(void);
+int param_store_stage(const char *name, double value);
+int param_store_commit(void);
+
+#endif
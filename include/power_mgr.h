@@ -0,0 +1,81 @@
+#ifndef __POWER_MGR_H__
+#define __POWER_MGR_H__
+
+#include <stdint.h>
+
+#define POWER_MGR_LIGHT_MIN_MS      20      // 空闲窗口短于该值（2 个系统节拍）不进入浅睡眠
+#define POWER_MGR_DEEP_MIN_MS       200     // 深睡眠进出与外设恢复有开销，窗口不短于该值才值得进入
+/*
+ * 深睡眠掉电后 UART1（GPS）与 I2C（MAX30102/MAX30205）的配置丢失，摔倒按键（GPIO11/12）
+ * 也没有配置为深睡眠唤醒 IO，空闲时按下可能漏报。在唤醒处理中恢复这些外设并配置唤醒 IO
+ * 之前，默认只使用浅睡眠；深睡眠的选择与否决逻辑保留，打开该开关即可启用
+ */
+#ifndef POWER_MGR_DEEP_SLEEP
+#define POWER_MGR_DEEP_SLEEP        0
+#endif
+#define POWER_MGR_DTIM_MULTIPLE     3       // Wi-Fi 省电模式下每 3 个 DTIM 周期醒来接收 AP 缓存的帧
+#define POWER_MGR_BEACON_MS         102     // 典型信标间隔 100 TU，按 AP 的 DTIM 周期为 1 估算
+#define POWER_MGR_DTIM_MS           (POWER_MGR_DTIM_MULTIPLE * POWER_MGR_BEACON_MS)
+
+/***********************************************************************
+* 枚举类型: power_state_t
+* 说    明: 芯片功耗状态
+************************************************************************/
+typedef enum
+{
+    POWER_STATE_ACTIVE = 0,     // 运行或空闲但不睡眠
+    POWER_STATE_LIGHT,          // 浅睡眠：CPU 停止，外设保持，任意中断唤醒
+    POWER_STATE_DEEP,           // 深睡眠：大部分外设掉电，定时器、Wi-Fi 与唤醒 IO 唤醒
+    POWER_STATE_MAX,
+} power_state_t;
+
+/***********************************************************************
+* 枚举类型: power_src_t
+* 说    明: 通过 power_mgr_set_deadline 告知下一次唤醒时刻的任务与定时器；
+*           传感器调度器的截止时刻由 sensor_sched_next_deadline 直接读取
+************************************************************************/
+typedef enum
+{
+    POWER_SRC_MAIN = 0,         // 主任务周期定时器
+    POWER_SRC_COOLING,          // 降温继电器下一次切换
+    POWER_SRC_MAX,
+} power_src_t;
+
+/***********************************************************************
+* 枚举类型: power_veto_t
+* 说    明: 禁止深睡眠的条件，仍允许浅睡眠
+************************************************************************/
+typedef enum
+{
+    POWER_VETO_GPS_UART = 0,    // 接收机在输出 NMEA，串口掉电会丢数据
+    POWER_VETO_FALL_BUTTON,     // 按键中断已触发、消抖未完成
+    POWER_VETO_COOLING,         // 继电器吸合中，深睡眠不保持 GPIO 输出
+    POWER_VETO_MAX,
+} power_veto_t;
+
+/***********************************************************************
+* 结构体名称: power_stats_t
+* 说    明: 功耗状态统计
+* 成    员: residency_ms    - 各状态累计驻留时间，ACTIVE 为总时间减去睡眠时间
+*           entries         - 各睡眠状态的进入次数
+*           early_wakes     - 早于计划时刻醒来的次数（中断、Wi-Fi 收包）
+*           short_idle      - 空闲窗口过短而不睡眠的次数
+*           vetoes          - 窗口足够但因各否决条件改为浅睡眠的次数
+************************************************************************/
+typedef struct
+{
+    uint32_t residency_ms[POWER_STATE_MAX];
+    uint32_t entries[POWER_STATE_MAX];
+    uint32_t early_wakes;
+    uint32_t short_idle;
+    uint32_t vetoes[POWER_VETO_MAX];
+} power_stats_t;
+
+int power_mgr_init(void);
+int power_mgr_wifi_ps(int enable);
+void power_mgr_set_deadline(power_src_t src, uint32_t deadline_ms);
+void power_mgr_veto(power_veto_t veto, int on);
+void power_mgr_get_stats(power_stats_t *stats);
+void power_mgr_print_stats(void);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __REPORT_DELTA_H__
+#define __REPORT_DELTA_H__
+
+#include <stdint.h>
+#include "oc_mqtt.h"
+
+#define REPORT_DELTA_STR_LEN    48      // 字符串属性参与比较的最大长度，需容纳告警时延直方图
+
+/***********************************************************************
+* 结构体名称: report_delta_t
+* 说    明: 单个属性的变化检测配置与状态。数值变化超过
+*           max(abs_band, rel_band * |上次上报值|) 或静默超过 max_silence_ms 时上报；
+*           字符串属性内容变化即上报
+* 成    员: key             - 属性名，与 oc_mqtt_profile_kv_t 的 key 一致
+*           abs_band        - 绝对死区，0 表示任何变化都上报
+*           rel_band        - 相对死区（比例）
+*           max_silence_ms  - 最长静默时间
+*           其余为运行状态，初始化为 0
+************************************************************************/
+typedef struct
+{
+    const char *key;
+    float abs_band;
+    float rel_band;
+    uint32_t max_silence_ms;
+    double last;
+    char last_str[REPORT_DELTA_STR_LEN];
+    uint32_t last_ms;
+    uint8_t sent;
+    uint8_t pending;
+} report_delta_t;
+
+/***********************************************************************
+* 结构体名称: report_delta_stats_t
+* 说    明: 变化检测统计
+************************************************************************/
+typedef struct
+{
+    uint32_t reports;           // 实际发出的上报次数
+    uint32_t reports_skipped;   // 没有任何属性需要上报而省略的次数
+    uint32_t full_reports;      // 全量快照次数
+    uint32_t props_sent;        // 发出的属性数
+    uint32_t props_suppressed;  // 因未超出死区而省略的属性数
+} report_delta_stats_t;
+
+oc_mqtt_profile_kv_t *report_delta_select(report_delta_t *props, oc_mqtt_profile_kv_t *kv, int count,
+                                          uint32_t now_ms, int full);
+void report_delta_commit(report_delta_t *props, const oc_mqtt_profile_kv_t *kv, int count, uint32_t now_ms);
+void report_delta_get_stats(report_delta_stats_t *stats);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __SENSOR_SCHED_H__
+#define __SENSOR_SCHED_H__
+
+#include <stdint.h>
+
+#define SENSOR_SCHED_MAX_JOBS   8
+
+typedef void (*sensor_job_fn_t)(uint32_t now_ms, void *arg);
+
+/***********************************************************************
+* 结构体名称: sensor_job_stats_t
+* 说    明: 单个作业的运行统计
+* 成    员: runs            - 执行次数
+*           overruns        - 因执行过晚或耗时过长而跳过的周期数
+*           jitter_max_ms   - 实际开始时刻晚于计划时刻的最大值
+*           jitter_total_ms - 上述延迟的累计值，除以 runs 得平均抖动
+*           run_max_ms      - 单次执行的最长耗时
+************************************************************************/
+typedef struct
+{
+    const char *name;
+    uint32_t period_ms;
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t jitter_max_ms;
+    uint32_t jitter_total_ms;
+    uint32_t run_max_ms;
+} sensor_job_stats_t;
+
+int sensor_sched_add(const char *name, uint32_t period_ms, uint32_t phase_ms, sensor_job_fn_t fn, void *arg);
+int sensor_sched_set_period(int id, uint32_t period_ms);
+uint32_t sensor_sched_next_deadline(void);
+void sensor_sched_run(void);
+int sensor_sched_get_stats(int id, sensor_job_stats_t *stats);
+void sensor_sched_print_stats(void);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __TEMP_FILTER_H__
+#define __TEMP_FILTER_H__
+
+#include <stdint.h>
+
+#define TEMP_FILTER_ALPHA          0.25f    // 位置（温度）修正增益
+#define TEMP_FILTER_BETA           0.02f    // 速度（温升率）修正增益
+#define TEMP_FILTER_MAX_DT_MS      30000    // 超过该间隔视为断流，重新初始化
+#define TEMP_FILTER_MIN_VALID      10.0f    // 有效体表温度下限，低于此值视为读取失败
+#define TEMP_FILTER_MAX_VALID      50.0f    // 有效体表温度上限
+#define TEMP_PREDICT_HORIZON_S     120      // 短时预测时长（秒）
+
+/***********************************************************************
+* 结构体名称: temp_filter_t
+* 说    明: MAX30205 体温 alpha-beta 滤波器状态
+* 成    员: temp         - 平滑后的温度（°C）
+*           rate         - 温度变化率（°C/s）
+*           last_ms      - 上一次更新的时间戳（毫秒）
+*           initialized  - 是否已收到第一帧有效数据
+************************************************************************/
+typedef struct
+{
+    float temp;
+    float rate;
+    uint32_t last_ms;
+    int initialized;
+} temp_filter_t;
+
+void temp_filter_init(temp_filter_t *f);
+int temp_filter_update(temp_filter_t *f, float measured, uint32_t now_ms);
+float temp_filter_rate_per_min(const temp_filter_t *f);
+float temp_filter_predict(const temp_filter_t *f, uint32_t horizon_s);
+
+#endif
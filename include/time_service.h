@@ -0,0 +1,40 @@
+#ifndef __TIME_SERVICE_H__
+#define __TIME_SERVICE_H__
+
+#include <stdint.h>
+
+#ifndef TIME_SNTP_SERVER
+#define TIME_SNTP_SERVER        "ntp.aliyun.com"
+#endif
+#define TIME_SNTP_INTERVAL_MS   (60 * 60 * 1000)    // 没有 GPS 授时时 SNTP 校时间隔
+#define TIME_SNTP_RETRY_MS      (60 * 1000)         // SNTP 失败后的重试间隔
+#define TIME_SNTP_CHECK_MS      (10 * 1000)         // 校时任务检查是否需要校时的间隔
+#define TIME_SNTP_TASK_STACK    2048
+#define TIME_SNTP_TASK_PRIO     22                  // 低于主任务（24）与降温任务（23），校时阻塞不影响其他任务
+#define TIME_GPS_HOLD_MS        (10 * 60 * 1000)    // GPS 授时后该时长内不采用 SNTP
+#define TIME_STEP_MS            2000                // 偏差超过该值直接跳变，否则逐步修正
+#define TIME_SLEW_SHIFT         2                   // 小偏差每次修正 1/4
+#define TIME_EVENT_TIME_LEN     17                  // "yyyyMMddTHHmmssZ" 含结尾 '\0'
+
+/***********************************************************************
+* 枚举类型: time_source_t
+* 说    明: 当前 UTC 时间来源
+************************************************************************/
+typedef enum
+{
+    TIME_SRC_NONE = 0,
+    TIME_SRC_SNTP,
+    TIME_SRC_GPS,
+} time_source_t;
+
+int time_service_init(void);
+void time_service_sync(uint64_t utc_ms, uint32_t mono_ms, time_source_t src);
+void time_service_sync_gps(uint32_t utc_date, uint32_t utc_time, uint32_t mono_ms);
+int time_service_start_sntp(void);
+void time_service_set_sntp_server(const char *server);
+int time_service_utc_ms(uint32_t mono_ms, uint64_t *utc_ms);
+int time_service_format(uint32_t mono_ms, char *buf, int len);
+int time_service_utc_nmea(uint32_t mono_ms, uint32_t *utc_date, uint32_t *utc_time);
+time_source_t time_service_source(void);
+
+#endif
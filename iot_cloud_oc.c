@@ -6,6 +6,7 @@
 ************************************************************************/
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include "ohos_init.h"
@@ -21,8 +22,53 @@
 #include <cJSON.h>
 #include "max30205.h"
 #include "hi_task.h"
+#include "hi_time.h"
+#include "temp_filter.h"
+#include "gps_power.h"
+#include "gps_aiding.h"
+#include "nv_store.h"
+#include "geofence.h"
+#include "gps_track.h"
+#include "time_service.h"
+#include "mem_pool.h"
+#include "sensor_sched.h"
+#include "report_delta.h"
+#include "msg_lane.h"
+#include "fall_button.h"
+#include "alarm_pub.h"
+#include "cooling.h"
+#include "cmd_registry.h"
+#include "param_store.h"
+#include "device_shadow.h"
+#include "power_mgr.h"
 
 #define MSGQUEUE_OBJECTS 16
+#define CMD_PAYLOAD_SLOTS   4       // 同时在队列中等待处理的命令数
+#define CMD_PAYLOAD_LEN     512     // 单条命令 JSON 的最大长度（含结尾 '\0'）
+#define CMD_REQUEST_ID_LEN  48      // 平台请求 ID 的最大长度（含结尾 '\0'）
+#define TELEMETRY_LANE_DEPTH    4   // 周期上报通道深度，满后新上报合并进队列中的上报
+#define APP_MSG_CRITICAL_WAIT_MS    200 // 关键事件在消息池耗尽时等待主任务释放消息的最长时间
+
+#define LOCATION_HEARTBEAT_MS   (5 * 60 * 1000)     // 无区域事件时位置随周期上报的最长间隔
+
+#define SENSOR_PPG_PERIOD_MS        SAMPLE_INTERVAL_MS  // 心率/血氧采样 25 Hz
+#define SENSOR_TEMP_PERIOD_MS       5000    // 体温 0.2 Hz
+#define SENSOR_GPS_PERIOD_MS        1000    // 位置 / 电子围栏 1 Hz，与 GPS 输出频率一致
+#define SENSOR_COOLING_PERIOD_MS    1000    // 降温控制输入更新 1 Hz，输出由降温任务按 10 s 周期调节
+#define SENSOR_STATS_PERIOD_MS      (60 * 1000)
+
+#define REPORT_FULL_MS          (30 * 60 * 1000)    // 全量快照间隔
+#define REPORT_SILENCE_MS       (10 * 60 * 1000)    // 生理数据最长静默时间
+#define REPORT_STATUS_SILENCE_MS    (30 * 60 * 1000)    // 状态类属性最长静默时间
+
+#define MAIN_EVT_MSG        0x01U   // 消息队列有新消息
+#define MAIN_EVT_TIMER      0x02U   // 周期定时器到期（轨迹上传、连接检查与重连）
+#define MAIN_EVT_CONN       0x04U   // 平台连接状态变化
+#define MAIN_EVT_ALL        (MAIN_EVT_MSG | MAIN_EVT_TIMER | MAIN_EVT_CONN)
+#define MAIN_TICK_MS        1000    // 主任务周期工作的间隔
+#define MAIN_STATS_MS       (60 * 1000)     // 打印分发延迟统计的间隔
+#define MAIN_RECONNECT_MIN_MS   2000            // 断线后第一次重连前的等待，失败后逐次加倍
+#define MAIN_RECONNECT_MAX_MS   (60 * 1000)     // 重连间隔上限
 
 /***********************************************************************
 * 结构体名称: MSGQUEUE_OBJ_t
@@ -37,14 +83,12 @@ typedef struct
 } MSGQUEUE_OBJ_t;
 
 MSGQUEUE_OBJ_t msg;
-osMessageQueueId_t mid_MsgQueue;
 
 #define CLIENT_ID "685ff8bcd582f20018360398_20250628_0_0_2025070907"
 #define USERNAME "685ff8bcd582f20018360398_20250628"
 #define PASSWORD "9f14ab6d439f45b6062624205942b49eaddb3b6800c279ab121f8f072254b437"
 
 void UartExampleEntry(void);
-void RunGPS(double *lat, double *lon);
 
 /***********************************************************************
 * 枚举类型: en_msg_type_t
@@ -54,16 +98,20 @@ typedef enum
 {
     en_msg_cmd = 0,
     en_msg_report,
+    en_msg_geofence,
+    en_msg_alarm,
+    en_msg_max,
 } en_msg_type_t;
 
 /***********************************************************************
 * 结构体名称: cmd_t
-* 说    明: 命令消息结构体
+* 说    明: 平台下行消息结构体（命令、属性设置等）
 ************************************************************************/
 typedef struct
 {
-    char *request_id;
-    char *payload;
+    int type;               // en_oc_mqtt_profile_msg_type_down_t
+    char request_id[CMD_REQUEST_ID_LEN];    // 来自下行主题，响应时原样带回
+    char *payload;          // 指向命令缓存池中的拷贝，随消息一起释放
 } cmd_t;
 
 /***********************************************************************
@@ -72,26 +120,54 @@ typedef struct
 ************************************************************************/
 typedef struct
 {
-    int lum;
     int temp;
-    int hum;
     int heart_rate;
     int spo2;
-    double lat ;
-    double lon ;
+    double temp_rate;
+    double temp_predict;
+    int has_location;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    int speed_cms;
+    int heading;
+    int gps_ttff;
+    int alarm_count;        // 已确认送达的告警数
+    int alarm_latency_max;  // 告警从按键中断到 PUBACK 的最大时延（毫秒）
+    char alarm_hist[ALARM_PUB_HIST_STR_LEN];    // 告警时延直方图各桶计数
+    int cooling_duty;       // 降温占空比（%）
+    int cooling_energy;     // 降温累计能耗估算（mWh）
+    int param_version;      // 生效的参数集版本
+    int sleep_pct;          // 上电以来处于浅睡眠 / 深睡眠的时间占比（%）
+    uint32_t sample_ms;     // 采样时刻，上报时换算为 event_time
 } report_t;
 
+/***********************************************************************
+* 结构体名称: alarm_t
+* 说    明: 告警消息结构体，由按键任务在消抖确认后产生
+************************************************************************/
+typedef struct
+{
+    int fallen;             // 1 摔倒，0 恢复
+    uint32_t isr_ms;        // 按键中断时刻，上报时换算为 event_time
+    int has_location;
+    int32_t lat_e7;
+    int32_t lon_e7;
+} alarm_t;
+
 /***********************************************************************
 * 结构体名称: app_msg_t
-* 说    明: 应用消息联合结构，支持命令和上报两种类型
+* 说    明: 应用消息联合结构，支持命令、上报、区域事件和告警四种类型
 ************************************************************************/
 typedef struct
 {
     en_msg_type_t msg_type;
+    uint32_t post_ms;       // 入队时刻，用于统计分发延迟
     union
     {
         cmd_t cmd;
         report_t report;
+        geofence_event_t geofence;
+        alarm_t alarm;
     } msg;
 } app_msg_t;
 
@@ -108,354 +184,1626 @@ typedef struct
 static app_cb_t g_app_cb;
 
 /***********************************************************************
-* 函数名称: deal_report_msg
-* 说    明: 处理上报消息，构造 MQTT 属性报告内容并发送
-* 参    数: report - 指向上报数据结构体
-* 返 回 值: 无
+* 结构体名称: dispatch_stat_t
+* 说    明: 主任务按事件类型统计的分发延迟（事件产生到开始处理）与处理耗时
 ************************************************************************/
-static void deal_report_msg(report_t *report)
+typedef struct
 {
-    oc_mqtt_profile_service_t service;
-    oc_mqtt_profile_kv_t temperature;
-    oc_mqtt_profile_kv_t humidity;
-    oc_mqtt_profile_kv_t luminance;
-    oc_mqtt_profile_kv_t heart_rate;
-    oc_mqtt_profile_kv_t spo2;
-    oc_mqtt_profile_kv_t led;
-    oc_mqtt_profile_kv_t motor;
-    oc_mqtt_profile_kv_t lat;
-    oc_mqtt_profile_kv_t lon;
+    uint32_t count;
+    uint32_t latency_total_ms;
+    uint32_t latency_max_ms;
+    uint32_t run_max_ms;
+} dispatch_stat_t;
 
-    char lat_str[32], lon_str[32];
-    snprintf(lat_str, sizeof(lat_str), "%.6f", report->lat);
-    snprintf(lon_str, sizeof(lon_str), "%.6f", report->lon);
-    
-    service.event_time = NULL;
-    service.service_id = "Agriculture";
-    service.service_property = &temperature;
-    service.nxt = NULL;
+#define DISPATCH_TIMER      en_msg_max
+#define DISPATCH_CONN       (en_msg_max + 1)
+#define DISPATCH_KINDS      (en_msg_max + 2)
 
-    temperature.key = "Temperature";
-    temperature.value = &report->temp;
-    temperature.type = EN_OC_MQTT_PROFILE_VALUE_INT;
-    temperature.nxt = &humidity;
-
-    humidity.key = "Humidity";
-    humidity.value = &report->hum;
-    humidity.type = EN_OC_MQTT_PROFILE_VALUE_INT;
-    humidity.nxt = &luminance;
-
-    luminance.key = "Luminance";
-    luminance.value = &report->lum;
-    luminance.type = EN_OC_MQTT_PROFILE_VALUE_INT;
-    luminance.nxt = &heart_rate;
-
-    heart_rate.key = "Heart_rate";
-    heart_rate.value = &report->heart_rate;
-    heart_rate.type = EN_OC_MQTT_PROFILE_VALUE_INT;
-    heart_rate.nxt = &spo2;
-
-    spo2.key = "Spo2";
-    spo2.value = &report->spo2;
-    spo2.type = EN_OC_MQTT_PROFILE_VALUE_INT;
-    spo2.nxt = &led;
-
-    led.key = "LightStatus";
-    led.value = g_app_cb.led ? "ON" : "OFF";
-    led.type = EN_OC_MQTT_PROFILE_VALUE_STRING;
-    led.nxt = &motor;
-
-    motor.key = "MotorStatus";
-    motor.value = g_app_cb.motor ? "ON" : "OFF";
-    motor.type = EN_OC_MQTT_PROFILE_VALUE_STRING;
-    motor.nxt = &lat;
+static const char *g_dispatch_names[DISPATCH_KINDS] = { "cmd", "report", "geofence", "alarm", "timer", "conn" };
+static dispatch_stat_t g_dispatch_stats[DISPATCH_KINDS];
+static osEventFlagsId_t g_main_events = NULL;
+static volatile uint32_t g_timer_post_ms;
+static uint32_t g_main_period_ms = MAIN_TICK_MS;   // 换算成节拍后定时器的实际周期，发布给功耗管理
+static volatile uint32_t g_conn_post_ms;
+static int g_report_full = 0;       // 下一次上报发送全量快照
+static alarm_t g_alarm_pending;     // 快速通道与主任务都未送达的最新告警，连上平台后补发
+static int g_alarm_pending_valid = 0;
+static int g_report_job = -1;       // 属性上报作业，周期可由平台命令修改
 
-    lat.key = "Lat";
-    lat.value = lat_str;
-    lat.type = EN_OC_MQTT_PROFILE_VALUE_STRING;
-    lat.nxt = &lon;
+/***********************************************************************
+* 枚举类型: 上报属性序号
+* 说    明: 与 g_report_props 一一对应
+************************************************************************/
+enum
+{
+    REPORT_TEMP = 0,
+    REPORT_TEMP_RATE,
+    REPORT_TEMP_PREDICT,
+    REPORT_HEART_RATE,
+    REPORT_SPO2,
+    REPORT_LED,
+    REPORT_MOTOR,
+    REPORT_LAT,
+    REPORT_LON,
+    REPORT_SPEED,
+    REPORT_HEADING,
+    REPORT_GPS_TTFF,
+    REPORT_ALARM_COUNT,
+    REPORT_ALARM_LATENCY,
+    REPORT_COOLING_DUTY,
+    REPORT_COOLING_ENERGY,
+    REPORT_PARAM_VERSION,
+    REPORT_SLEEP_PCT,
+    REPORT_ALARM_HIST,
+    REPORT_PROP_MAX,
+};
 
-    lon.key = "Lon";
-    lon.value = lon_str;
-    lon.type = EN_OC_MQTT_PROFILE_VALUE_STRING;
-    lon.nxt = NULL;
+// 各属性的死区与最长静默时间；位置只在心跳周期到达时出现，出现即与上次比较
+static report_delta_t g_report_props[REPORT_PROP_MAX] =
+{
+    [REPORT_TEMP]         = { "Temperature", 0.0f, 0.0f, REPORT_SILENCE_MS },
+    [REPORT_TEMP_RATE]    = { "Temp_rate", 0.05f, 0.2f, REPORT_SILENCE_MS },
+    [REPORT_TEMP_PREDICT] = { "Temp_predict", 0.1f, 0.0f, REPORT_SILENCE_MS },
+    [REPORT_HEART_RATE]   = { "Heart_rate", 3.0f, 0.05f, REPORT_SILENCE_MS },
+    [REPORT_SPO2]         = { "Spo2", 1.0f, 0.0f, REPORT_SILENCE_MS },
+    [REPORT_LED]          = { "LightStatus", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_MOTOR]        = { "MotorStatus", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_LAT]          = { "Lat", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_LON]          = { "Lon", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_SPEED]        = { "Speed", 50.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_HEADING]      = { "Heading", 15.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_GPS_TTFF]     = { "GPS_TTFF", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_ALARM_COUNT]  = { "Alarm_count", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_ALARM_LATENCY] = { "Alarm_latency_max", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_COOLING_DUTY] = { "Cooling_duty", 10.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_COOLING_ENERGY] = { "Cooling_energy", 50.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_PARAM_VERSION] = { "Param_version", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_SLEEP_PCT]    = { "Sleep_pct", 2.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+    [REPORT_ALARM_HIST]   = { "Alarm_latency_hist", 0.0f, 0.0f, REPORT_STATUS_SILENCE_MS },
+};
 
-    oc_mqtt_profile_propertyreport(USERNAME, &service);
-    return;
-}
+/***********************************************************************
+* 枚举类型: 影子属性序号
+* 说    明: 与 g_shadow_defs 一一对应，同时更新的属性相邻排列
+************************************************************************/
+enum
+{
+    SHADOW_TEMP = 0,
+    SHADOW_TEMP_RATE,
+    SHADOW_TEMP_PREDICT,
+    SHADOW_HEART_RATE,
+    SHADOW_SPO2,
+    SHADOW_LED,
+    SHADOW_MOTOR,
+    SHADOW_LAT,
+    SHADOW_LON,
+    SHADOW_SPEED,
+    SHADOW_HEADING,
+    SHADOW_GPS_TTFF,
+    SHADOW_FALL_STATUS,
+    SHADOW_ALARM_COUNT,
+    SHADOW_ALARM_LATENCY,
+    SHADOW_COOLING_DUTY,
+    SHADOW_COOLING_ENERGY,
+    SHADOW_SLEEP_PCT,
+    SHADOW_PARAM_VERSION,
+    SHADOW_PARAM_BASE,      // 可调参数，顺序与 param_id_t 一致，属性名在 shadow_init 中填写
+    SHADOW_PROP_MAX = SHADOW_PARAM_BASE + PARAM_MAX,
+};
+
+static const char *const g_onoff_names[] = { "OFF", "ON", NULL };
+static const char *const g_fall_names[] = { "OK", "FALL", NULL };
+
+// 平台属性查询直接由影子响应，各处理阶段得出结果时写入
+static shadow_def_t g_shadow_defs[SHADOW_PROP_MAX] =
+{
+    [SHADOW_TEMP]           = { "Agriculture", "Temperature", SHADOW_TYPE_FLOAT, NULL },
+    [SHADOW_TEMP_RATE]      = { "Agriculture", "Temp_rate", SHADOW_TYPE_FLOAT, NULL },
+    [SHADOW_TEMP_PREDICT]   = { "Agriculture", "Temp_predict", SHADOW_TYPE_FLOAT, NULL },
+    [SHADOW_HEART_RATE]     = { "Agriculture", "Heart_rate", SHADOW_TYPE_INT, NULL },
+    [SHADOW_SPO2]           = { "Agriculture", "Spo2", SHADOW_TYPE_INT, NULL },
+    [SHADOW_LED]            = { "Agriculture", "LightStatus", SHADOW_TYPE_ENUM, g_onoff_names },
+    [SHADOW_MOTOR]          = { "Agriculture", "MotorStatus", SHADOW_TYPE_ENUM, g_onoff_names },
+    [SHADOW_LAT]            = { "Agriculture", "Lat", SHADOW_TYPE_E7, NULL },
+    [SHADOW_LON]            = { "Agriculture", "Lon", SHADOW_TYPE_E7, NULL },
+    [SHADOW_SPEED]          = { "Agriculture", "Speed", SHADOW_TYPE_INT, NULL },
+    [SHADOW_HEADING]        = { "Agriculture", "Heading", SHADOW_TYPE_INT, NULL },
+    [SHADOW_GPS_TTFF]       = { "Agriculture", "GPS_TTFF", SHADOW_TYPE_INT, NULL },
+    [SHADOW_FALL_STATUS]    = { "Agriculture", "FallStatus", SHADOW_TYPE_ENUM, g_fall_names },
+    [SHADOW_ALARM_COUNT]    = { "Agriculture", "Alarm_count", SHADOW_TYPE_INT, NULL },
+    [SHADOW_ALARM_LATENCY]  = { "Agriculture", "Alarm_latency_max", SHADOW_TYPE_INT, NULL },
+    [SHADOW_COOLING_DUTY]   = { "Agriculture", "Cooling_duty", SHADOW_TYPE_INT, NULL },
+    [SHADOW_COOLING_ENERGY] = { "Agriculture", "Cooling_energy", SHADOW_TYPE_INT, NULL },
+    [SHADOW_SLEEP_PCT]      = { "Agriculture", "Sleep_pct", SHADOW_TYPE_INT, NULL },
+    [SHADOW_PARAM_VERSION]  = { "Agriculture", "Param_version", SHADOW_TYPE_INT, NULL },
+};
+
+// 应用消息与命令内容都来自静态内存池，稳定运行时不经过堆分配，长期运行不产生碎片
+static app_msg_t g_msg_blocks[MSGQUEUE_OBJECTS];
+static mem_pool_t g_msg_pool;
+static void *g_cmd_blocks[CMD_PAYLOAD_SLOTS][CMD_PAYLOAD_LEN / sizeof(void *)];
+static mem_pool_t g_cmd_pool;
+static uint32_t g_msg_drops[en_msg_max];    // 按类型统计池耗尽、队列满或内容过长丢弃的消息数
+
+/*
+ * 按优先级分通道，主任务总是先取完高优先级通道。
+ * 周期上报最多占用 TELEMETRY_LANE_DEPTH + 1 个消息、命令最多 CMD_PAYLOAD_SLOTS + 1 个，
+ * 其余消息池留给关键事件；关键事件分配时短暂等待空闲消息，关键通道容量等于消息池大小。
+ * 只有主任务长时间不取消息、关键事件占满消息池时才丢弃，计入丢弃数
+ */
+enum
+{
+    LANE_CRITICAL = 0,      // 告警、区域事件
+    LANE_COMMAND,           // 平台下发命令
+    LANE_TELEMETRY,         // 周期属性上报
+    LANE_MAX,
+};
+static msg_lane_t g_lanes[LANE_MAX];
 
 /***********************************************************************
-* 函数名称: oc_cmd_rsp_cb
-* 说    明: 接收到平台下发命令后的回调函数
-* 参    数: recv_data - 命令数据
-*           recv_size - 数据长度
-*           resp_data - 返回数据
-*           resp_size - 返回长度
-* 返 回 值: 无
+* 函数名称: app_msg_lane
+* 说    明: 消息类型对应的通道
+* 参    数: type - 消息类型
+* 返 回 值: 通道序号
 ************************************************************************/
-void oc_cmd_rsp_cb(uint8_t *recv_data, size_t recv_size, uint8_t **resp_data, size_t *resp_size)
+static int app_msg_lane(en_msg_type_t type)
 {
-    app_msg_t *app_msg;
+    switch (type)
+    {
+    case en_msg_cmd:
+        return LANE_COMMAND;
+    case en_msg_report:
+        return LANE_TELEMETRY;
+    default:
+        return LANE_CRITICAL;
+    }
+}
 
-    int ret = 0;
-    app_msg = malloc(sizeof(app_msg_t));
-    app_msg->msg_type = en_msg_cmd;
-    app_msg->msg.cmd.payload = (char *)recv_data;
+/***********************************************************************
+* 函数名称: app_msg_merge_report
+* 说    明: 上报通道满时把新上报合并进队列中的上报：取新的测量值，
+*           新上报不带位置时保留原有位置，保证心跳位置不丢
+* 参    数: queued - 队列中的消息
+*           msg - 新消息
+* 返 回 值: 1 已合并，0 类型不同不能合并
+************************************************************************/
+static int app_msg_merge_report(void *queued, const void *msg)
+{
+    app_msg_t *dst = (app_msg_t *)queued;
+    const app_msg_t *src = (const app_msg_t *)msg;
+    report_t old;
 
-    printf("recv data is %.*s\n", recv_size, recv_data);
-    ret = osMessageQueuePut(mid_MsgQueue, &app_msg, 0U, 0U);
-    if (ret != 0)
+    if (dst->msg_type != en_msg_report || src->msg_type != en_msg_report)
     {
-        free(recv_data);
+        return 0;
     }
-    *resp_data = NULL;
-    *resp_size = 0;
+    old = dst->msg.report;
+    dst->msg.report = src->msg.report;
+    if (!src->msg.report.has_location && old.has_location)
+    {
+        dst->msg.report.has_location = 1;
+        dst->msg.report.lat_e7 = old.lat_e7;
+        dst->msg.report.lon_e7 = old.lon_e7;
+        dst->msg.report.speed_cms = old.speed_cms;
+        dst->msg.report.heading = old.heading;
+    }
+    return 1;
 }
 
+/***********************************************************************
+* 函数名称: main_ms_to_ticks
+* 说    明: 毫秒转换为系统节拍（CMSIS 定时器与延时均以节拍为单位），向上取整，至少 1 个节拍
+* 参    数: ms - 毫秒
+* 返 回 值: 节拍数
+************************************************************************/
+static uint32_t main_ms_to_ticks(uint32_t ms)
+{
+    uint32_t ticks = (uint32_t)(((uint64_t)ms * osKernelGetTickFreq() + 999) / 1000);
+
+    return ticks > 0 ? ticks : 1;
+}
 
 /***********************************************************************
-* 函数名称: deal_cmd_msg
-* 说    明: 处理平台下发的命令
-* 参    数: cmd - 指向命令结构体
-* 返 回 值: 无
+* 函数名称: app_msg_alloc
+* 说    明: 从消息池取一个消息，关键事件在池耗尽时最多等待 APP_MSG_CRITICAL_WAIT_MS
+*           让主任务释放消息；主任务卡住时放弃，不让传感器与按键任务一直阻塞
+* 参    数: type - 消息类型
+* 返 回 值: 消息，池已耗尽返回 NULL 并计入丢弃数
 ************************************************************************/
-static void deal_cmd_msg(cmd_t *cmd)
+static app_msg_t *app_msg_alloc(en_msg_type_t type)
 {
-    cJSON *obj_root;
-    cJSON *obj_cmdname;
-    cJSON *obj_paras;
-    cJSON *obj_para;
+    uint32_t timeout = (LANE_CRITICAL == app_msg_lane(type)) ? main_ms_to_ticks(APP_MSG_CRITICAL_WAIT_MS) : 0U;
+    app_msg_t *app_msg = mem_pool_alloc_timeout(&g_msg_pool, timeout);
 
-    int cmdret = 1;
-    oc_mqtt_profile_cmdresp_t cmdresp;
-    obj_root = cJSON_Parse(cmd->payload);
-    if (NULL == obj_root)
+    if (NULL == app_msg)
     {
-        goto EXIT_JSONPARSE;
+        g_msg_drops[type]++;
+        if (0U != timeout)
+        {
+            printf("[main] msg pool exhausted, %s dropped\n", g_dispatch_names[type]);
+        }
+        return NULL;
     }
+    memset(app_msg, 0, sizeof(app_msg_t));
+    app_msg->msg_type = type;
+    return app_msg;
+}
 
-    obj_cmdname = cJSON_GetObjectItem(obj_root, "command_name");
-    if (NULL == obj_cmdname)
+/***********************************************************************
+* 函数名称: app_msg_free
+* 说    明: 释放消息及其占用的命令缓存
+* 参    数: app_msg - 消息
+* 返 回 值: 无
+************************************************************************/
+static void app_msg_free(app_msg_t *app_msg)
+{
+    if (en_msg_cmd == app_msg->msg_type)
     {
-        goto EXIT_CMDOBJ;
+        mem_pool_free(&g_cmd_pool, app_msg->msg.cmd.payload);
     }
-    if (0 == strcmp(cJSON_GetStringValue(obj_cmdname), "Agriculture_Control_light"))
+    mem_pool_free(&g_msg_pool, app_msg);
+}
+
+/***********************************************************************
+* 函数名称: app_msg_post
+* 说    明: 消息放入对应优先级通道并唤醒主任务；周期上报通道满时合并进已有上报，
+*           合并或入队失败时消息被释放
+* 参    数: app_msg - 消息
+* 返 回 值: 0 成功（含合并），-1 通道已满
+************************************************************************/
+static int app_msg_post(app_msg_t *app_msg)
+{
+    int lane = app_msg_lane(app_msg->msg_type);
+    int ret;
+
+    app_msg->post_ms = hi_get_milli_seconds();
+    ret = msg_lane_put(&g_lanes[lane], app_msg, (LANE_TELEMETRY == lane) ? app_msg_merge_report : NULL);
+    if (0 != ret)
     {
-        obj_paras = cJSON_GetObjectItem(obj_root, "paras");
-        if (NULL == obj_paras)
-        {
-            goto EXIT_OBJPARAS;
-        }
-        obj_para = cJSON_GetObjectItem(obj_paras, "Light");
-        if (NULL == obj_para)
-        {
-            goto EXIT_OBJPARA;
-        }
-        ///< operate the LED here
-        if (0 == strcmp(cJSON_GetStringValue(obj_para), "ON"))
-        {
-            g_app_cb.led = 1;
-        }
-        else
+        if (ret < 0)
         {
-            g_app_cb.led = 0;
+            g_msg_drops[app_msg->msg_type]++;
         }
-        cmdret = 0;
+        app_msg_free(app_msg);
+        return (ret < 0) ? -1 : 0;
     }
-    else if (0 == strcmp(cJSON_GetStringValue(obj_cmdname), "Agriculture_Control_Motor"))
+    (void)osEventFlagsSet(g_main_events, MAIN_EVT_MSG);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: app_msg_take
+* 说    明: 按优先级取下一条消息
+* 参    数: 无
+* 返 回 值: 消息，所有通道为空返回 NULL
+************************************************************************/
+static app_msg_t *app_msg_take(void)
+{
+    app_msg_t *app_msg;
+
+    for (int i = 0; i < LANE_MAX; i++)
     {
-        obj_paras = cJSON_GetObjectItem(obj_root, "Paras");
-        if (NULL == obj_paras)
-        {
-            goto EXIT_OBJPARAS;
-        }
-        obj_para = cJSON_GetObjectItem(obj_paras, "Motor");
-        if (NULL == obj_para)
-        {
-            goto EXIT_OBJPARA;
-        }
-        ///< operate the Motor here
-        if (0 == strcmp(cJSON_GetStringValue(obj_para), "ON"))
+        app_msg = msg_lane_get(&g_lanes[i]);
+        if (NULL != app_msg)
         {
-            g_app_cb.motor = 1;
+            return app_msg;
         }
-        else
+    }
+    return NULL;
+}
+
+/***********************************************************************
+* 函数名称: dispatch_record
+* 说    明: 记录一次事件分发的延迟与处理耗时
+* 参    数: kind - 事件类型（消息类型或 DISPATCH_TIMER / DISPATCH_CONN）
+*           post_ms - 事件产生时刻
+*           start_ms - 开始处理时刻
+* 返 回 值: 无
+************************************************************************/
+static void dispatch_record(int kind, uint32_t post_ms, uint32_t start_ms)
+{
+    dispatch_stat_t *stat = &g_dispatch_stats[kind];
+    uint32_t latency = start_ms - post_ms;
+    uint32_t run = hi_get_milli_seconds() - start_ms;
+
+    stat->count++;
+    stat->latency_total_ms += latency;
+    if (latency > stat->latency_max_ms)
+    {
+        stat->latency_max_ms = latency;
+    }
+    if (run > stat->run_max_ms)
+    {
+        stat->run_max_ms = run;
+    }
+}
+
+/***********************************************************************
+* 函数名称: dispatch_print_stats
+* 说    明: 打印各事件类型的分发统计
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+static void dispatch_print_stats(void)
+{
+    report_delta_stats_t delta;
+
+    for (int i = 0; i < DISPATCH_KINDS; i++)
+    {
+        dispatch_stat_t *stat = &g_dispatch_stats[i];
+        if (stat->count == 0)
         {
-            g_app_cb.motor = 0;
+            continue;
         }
-        cmdret = 0;
+        printf("[main] %s n=%u latency avg=%u max=%u ms run max=%u ms\n", g_dispatch_names[i],
+               (unsigned)stat->count, (unsigned)(stat->latency_total_ms / stat->count),
+               (unsigned)stat->latency_max_ms, (unsigned)stat->run_max_ms);
     }
+    printf("[main] msg pool peak=%u/%u fail=%u, cmd pool peak=%u/%u fail=%u, drops cmd=%u report=%u geofence=%u alarm=%u\n",
+           g_msg_pool.peak, g_msg_pool.count, (unsigned)g_msg_pool.alloc_fail,
+           g_cmd_pool.peak, g_cmd_pool.count, (unsigned)g_cmd_pool.alloc_fail,
+           (unsigned)g_msg_drops[en_msg_cmd], (unsigned)g_msg_drops[en_msg_report],
+           (unsigned)g_msg_drops[en_msg_geofence], (unsigned)g_msg_drops[en_msg_alarm]);
+    for (int i = 0; i < LANE_MAX; i++)
+    {
+        msg_lane_print_stats(&g_lanes[i]);
+    }
+    alarm_pub_print_stats();
+    cmd_registry_print_stats();
+    report_delta_get_stats(&delta);
+    printf("[main] report sent=%u skipped=%u full=%u props sent=%u suppressed=%u\n",
+           (unsigned)delta.reports, (unsigned)delta.reports_skipped, (unsigned)delta.full_reports,
+           (unsigned)delta.props_sent, (unsigned)delta.props_suppressed);
+}
 
-EXIT_OBJPARA:
-EXIT_OBJPARAS:
-EXIT_CMDOBJ:
-    cJSON_Delete(obj_root);
-EXIT_JSONPARSE:
-    ///< do the response
-    cmdresp.paras = NULL;
-    cmdresp.request_id = cmd->request_id;
-    cmdresp.ret_code = cmdret;
-    cmdresp.ret_name = NULL;
-    (void)oc_mqtt_profile_cmdresp(NULL, &cmdresp);
-    return;
+/***********************************************************************
+* 函数名称: report_kv
+* 说    明: 填写一个上报属性，属性名取自变化检测表
+* 参    数: kv - 属性数组
+*           idx - 属性序号
+*           type - 数据类型
+*           value - 取值
+* 返 回 值: 无
+************************************************************************/
+static void report_kv(oc_mqtt_profile_kv_t *kv, int idx, en_oc_profile_data_t type, void *value)
+{
+    kv[idx].key = (char *)g_report_props[idx].key;
+    kv[idx].type = type;
+    kv[idx].value = value;
 }
 
 /***********************************************************************
-* 函数名称: task_main_entry
-* 说    明: 任务主线程，处理队列中接收到的消息
-* 参    数: 无
-* 返 回 值: 0（不退出）
+* 函数名称: deal_report_msg
+* 说    明: 处理上报消息，只把超出死区或静默超时的属性放入 MQTT 属性报告；
+*           每 REPORT_FULL_MS 及重新连上平台后发送一次全量快照
+* 参    数: report - 指向上报数据结构体
+* 返 回 值: 无
 ************************************************************************/
-static int task_main_entry(void)
+static void deal_report_msg(report_t *report)
 {
-    app_msg_t *app_msg;
+    static uint32_t last_full_ms = 0;
+    oc_mqtt_profile_service_t service;
+    oc_mqtt_profile_kv_t kv[REPORT_PROP_MAX];
+    char event_time[TIME_EVENT_TIME_LEN];
+    uint32_t now_ms = hi_get_milli_seconds();
+    int full;
 
-    uint32_t ret = WifiConnect("harmony", "harmony@11");   //需要设置连接WIFI
+    memset(kv, 0, sizeof(kv));
+    report_kv(kv, REPORT_TEMP, EN_OC_MQTT_PROFILE_VALUE_INT, &report->temp);
+    report_kv(kv, REPORT_TEMP_RATE, EN_OC_MQTT_PROFILE_VALUE_FLOAT, &report->temp_rate);
+    report_kv(kv, REPORT_TEMP_PREDICT, EN_OC_MQTT_PROFILE_VALUE_FLOAT, &report->temp_predict);
+    report_kv(kv, REPORT_HEART_RATE, EN_OC_MQTT_PROFILE_VALUE_INT, &report->heart_rate);
+    report_kv(kv, REPORT_SPO2, EN_OC_MQTT_PROFILE_VALUE_INT, &report->spo2);
+    report_kv(kv, REPORT_LED, EN_OC_MQTT_PROFILE_VALUE_STRING, g_app_cb.led ? "ON" : "OFF");
+    report_kv(kv, REPORT_MOTOR, EN_OC_MQTT_PROFILE_VALUE_STRING, g_app_cb.motor ? "ON" : "OFF");
+    // 位置只在心跳周期到达时随周期上报，其余由区域事件单独上报
+    if (report->has_location)
+    {
+        report_kv(kv, REPORT_LAT, EN_OC_MQTT_PROFILE_VALUE_E7, &report->lat_e7);
+        report_kv(kv, REPORT_LON, EN_OC_MQTT_PROFILE_VALUE_E7, &report->lon_e7);
+        // 滤波后的对地速度（cm/s）与航向（度）
+        report_kv(kv, REPORT_SPEED, EN_OC_MQTT_PROFILE_VALUE_INT, &report->speed_cms);
+        report_kv(kv, REPORT_HEADING, EN_OC_MQTT_PROFILE_VALUE_INT, &report->heading);
+    }
+    // 本次上电的首次定位时间（毫秒），尚未定位时为 0
+    report_kv(kv, REPORT_GPS_TTFF, EN_OC_MQTT_PROFILE_VALUE_INT, &report->gps_ttff);
+    // 告警送达情况：累计条数、按键中断到 PUBACK 的最坏时延与时延直方图
+    // （逗号分隔的各桶计数，桶上限 50/100/200/300/500/1000/2000 ms 及以上）
+    report_kv(kv, REPORT_ALARM_COUNT, EN_OC_MQTT_PROFILE_VALUE_INT, &report->alarm_count);
+    report_kv(kv, REPORT_ALARM_LATENCY, EN_OC_MQTT_PROFILE_VALUE_INT, &report->alarm_latency_max);
+    report_kv(kv, REPORT_ALARM_HIST, EN_OC_MQTT_PROFILE_VALUE_STRING, report->alarm_hist);
+    report_kv(kv, REPORT_COOLING_DUTY, EN_OC_MQTT_PROFILE_VALUE_INT, &report->cooling_duty);
+    report_kv(kv, REPORT_COOLING_ENERGY, EN_OC_MQTT_PROFILE_VALUE_INT, &report->cooling_energy);
+    // 平台据此确认参数修改已在设备上生效
+    report_kv(kv, REPORT_PARAM_VERSION, EN_OC_MQTT_PROFILE_VALUE_INT, &report->param_version);
+    // 睡眠时间占比决定续航，各状态驻留时间与否决次数见串口统计
+    report_kv(kv, REPORT_SLEEP_PCT, EN_OC_MQTT_PROFILE_VALUE_INT, &report->sleep_pct);
 
-    device_info_init(CLIENT_ID, USERNAME, PASSWORD);    //配置设备信息
-    oc_mqtt_init(); //初始化oc_mqtt
-    oc_set_cmd_rsp_cb(oc_cmd_rsp_cb);      //设置命令的回调函数oc_cmd_rsp_cb
+    full = g_report_full || (now_ms - last_full_ms >= REPORT_FULL_MS);
+    service.service_property = report_delta_select(g_report_props, kv, REPORT_PROP_MAX, now_ms, full);
+    if (NULL == service.service_property)
+    {
+        return;
+    }
+    // 未校时前不带 event_time，由平台按到达时间打戳
+    service.event_time = (time_service_format(report->sample_ms, event_time, sizeof(event_time)) == 0) ?
+                         event_time : NULL;
+    service.service_id = "Agriculture";
+    service.nxt = NULL;
 
-    while (1)
+    if (0 == oc_mqtt_profile_propertyreport(USERNAME, &service))
     {
-        app_msg = NULL;
-        (void)osMessageQueueGet(mid_MsgQueue, (void **)&app_msg, NULL, 0U);     //获取队列里面的消息
-        if (NULL != app_msg)
+        report_delta_commit(g_report_props, kv, REPORT_PROP_MAX, now_ms);
+        if (full)
         {
-            switch (app_msg->msg_type)
-            {
-            case en_msg_cmd:    //如果获取到cmd的消息，就调用cmd消息处理函数
-                deal_cmd_msg(&app_msg->msg.cmd);
-                break;
-            case en_msg_report: //如果获取到report消息，就对数据进行上报处理
-                deal_report_msg(&app_msg->msg.report);
-                break;
-            default:
-                break;
-            }
-            free(app_msg);
+            last_full_ms = now_ms;
+            g_report_full = 0;
         }
     }
-    return 0;
+    return;
 }
 
 /***********************************************************************
-* 函数名称: InitIO2
-* 说    明: 初始化GPIO2用于控制电平输出
-* 参    数: 无
+* 函数名称: deal_geofence_msg
+* 说    明: 上报区域进出 / 停留事件及事件发生时的位置
+* 参    数: evt - 区域事件
 * 返 回 值: 无
 ************************************************************************/
-#define IO2_GPIO_NAME HI_GPIO_IDX_2
-void InitIO2(void)
+static void deal_geofence_msg(geofence_event_t *evt)
 {
-    hi_gpio_init();  // 初始化 GPIO 模块
-    hi_gpio_set_dir(IO2_GPIO_NAME, HI_GPIO_DIR_OUT);  // 设置为输出模式
+    oc_mqtt_profile_service_t service;
+    oc_mqtt_profile_kv_t event;
+    oc_mqtt_profile_kv_t zone;
+    oc_mqtt_profile_kv_t dwell;
+    oc_mqtt_profile_kv_t lat;
+    oc_mqtt_profile_kv_t lon;
+    int zone_id = evt->zone_id;
+    int dwell_s = (int)evt->dwell_s;
+    char event_time[TIME_EVENT_TIME_LEN];
+
+    service.event_time = (time_service_format(evt->time_ms, event_time, sizeof(event_time)) == 0) ?
+                         event_time : NULL;
+    service.service_id = "Agriculture";
+    service.service_property = &event;
+    service.nxt = NULL;
+
+    event.key = "Geo_event";
+    event.value = (void *)geofence_event_name(evt->type);
+    event.type = EN_OC_MQTT_PROFILE_VALUE_STRING;
+    event.nxt = &zone;
+
+    zone.key = "Geo_zone";
+    zone.value = &zone_id;
+    zone.type = EN_OC_MQTT_PROFILE_VALUE_INT;
+    zone.nxt = &dwell;
+
+    dwell.key = "Geo_dwell";
+    dwell.value = &dwell_s;
+    dwell.type = EN_OC_MQTT_PROFILE_VALUE_INT;
+    dwell.nxt = &lat;
+
+    lat.key = "Lat";
+    lat.value = &evt->lat_e7;
+    lat.type = EN_OC_MQTT_PROFILE_VALUE_E7;
+    lat.nxt = &lon;
+
+    lon.key = "Lon";
+    lon.value = &evt->lon_e7;
+    lon.type = EN_OC_MQTT_PROFILE_VALUE_E7;
+    lon.nxt = NULL;
+
+    oc_mqtt_profile_propertyreport(USERNAME, &service);
 }
-static int fall_status = 0;
-static void F1_Pressed(char *arg)
+
+/***********************************************************************
+* 函数名称: alarm_send
+* 说    明: 经告警快速通道发送摔倒 / 恢复告警及按键时的位置，event_time 取按键中断时刻
+* 参    数: alarm - 告警
+* 返 回 值: 0 平台已确认，-1 失败
+************************************************************************/
+static int alarm_send(const alarm_t *alarm)
 {
-    (void)arg;
-    if (fall_status == 1) return;  // 已经是摔倒状态，直接返回
-    fall_status = 1;
-    GpioSetOutputVal(WIFI_IOT_IO_NAME_GPIO_2, 1);
-    //在这里写入F1被按下之后执行的操作(上传到华为云，已摔倒)
-    printf("有人摔倒了\n");
-    hi_sleep(300);
+    alarm_pub_stats_t stats;
+    shadow_value_t values[2];
+    int ret;
+
+    ret = alarm_pub_send(alarm->fallen, alarm->isr_ms,
+                         alarm->has_location ? &alarm->lat_e7 : NULL,
+                         alarm->has_location ? &alarm->lon_e7 : NULL);
+    if (0 == ret)
+    {
+        alarm_pub_get_stats(&stats);
+        values[0].i = (int32_t)stats.sent;
+        values[1].i = (int32_t)stats.total_max_ms;
+        device_shadow_update(SHADOW_ALARM_COUNT, values, 2);
+    }
+    return ret;
 }
-static void F2_Pressed(char *arg)
+
+/***********************************************************************
+* 函数名称: deal_alarm_msg
+* 说    明: 主任务补发快速通道未送达的告警，仍失败则保留最新一条，连上平台后再发
+* 参    数: alarm - 告警
+* 返 回 值: 无
+************************************************************************/
+static void deal_alarm_msg(alarm_t *alarm)
 {
-    (void)arg;
-    if (fall_status == 0) return;  // 已经是站立状态，直接返回
-    fall_status = 0;
-    GpioSetOutputVal(WIFI_IOT_IO_NAME_GPIO_2, 0);
-    //在这里写入F1被按下之后执行的操作(上传到华为云，取消已摔倒)
-    printf("站起来了\n");
-    hi_sleep(300);
-}
-static void Button(void)
-{
-    GpioInit();
-    //初始化LED灯
-    IoSetFunc(WIFI_IOT_IO_NAME_GPIO_2, WIFI_IOT_IO_FUNC_GPIO_2_GPIO);
-    GpioSetDir(WIFI_IOT_IO_NAME_GPIO_2, WIFI_IOT_GPIO_DIR_OUT);
-    //初始化F1按键，设置为下降沿触发中断
-    IoSetFunc(WIFI_IOT_IO_NAME_GPIO_11, WIFI_IOT_IO_FUNC_GPIO_11_GPIO);
-    GpioSetDir(WIFI_IOT_IO_NAME_GPIO_11, WIFI_IOT_GPIO_DIR_IN);
-    IoSetPull(WIFI_IOT_IO_NAME_GPIO_11, WIFI_IOT_IO_PULL_UP);
-    GpioRegisterIsrFunc(WIFI_IOT_IO_NAME_GPIO_11, WIFI_IOT_INT_TYPE_EDGE, WIFI_IOT_GPIO_EDGE_FALL_LEVEL_LOW, F1_Pressed, NULL);
-    //初始化F2按键，设置为下降沿触发中断
-    IoSetFunc(WIFI_IOT_IO_NAME_GPIO_12, WIFI_IOT_IO_FUNC_GPIO_12_GPIO);
-    GpioSetDir(WIFI_IOT_IO_NAME_GPIO_12, WIFI_IOT_GPIO_DIR_IN);
-    IoSetPull(WIFI_IOT_IO_NAME_GPIO_12, WIFI_IOT_IO_PULL_UP);
-    GpioRegisterIsrFunc(WIFI_IOT_IO_NAME_GPIO_12, WIFI_IOT_INT_TYPE_EDGE, WIFI_IOT_GPIO_EDGE_FALL_LEVEL_LOW, F2_Pressed, NULL);
+    if (0 == alarm_send(alarm))
+    {
+        g_alarm_pending_valid = 0;
+        return;
+    }
+    g_alarm_pending = *alarm;
+    g_alarm_pending_valid = 1;
 }
 
 /***********************************************************************
-* 函数名称: task_sensor_entry
-* 说    明: 传感器数据采集任务，获取环境数据并上报
+* 函数名称: deal_track_upload
+* 说    明: 编码压缩后的轨迹段，以一条消息上传，成功后才从缓存中移除；
+*           失败时轨迹段保留，下次连同新增的点一起上传
 * 参    数: 无
-* 返 回 值: 0（不退出）
+* 返 回 值: 无
 ************************************************************************/
-static int task_sensor_entry(void)
+static void deal_track_upload(void)
 {
-    app_msg_t *app_msg;
-    double lat = 0.0, lon = 0.0;  // 存储GPS经纬度
-    float temperature = 0.0;
-    max30205_init(); // 初始化温度传感器
-    max30102_app_entry();
-    printf("初始化完成\n");
-    UartExampleEntry();
-    printf("初始化定位成功\n");
-    Button();
-    while (1)
+    static char buf[GPS_TRACK_B64_SIZE];    // 只在主任务中使用
+    oc_mqtt_profile_msgup_t msgup;
+    int len;
+
+    len = gps_track_encode(buf, GPS_TRACK_B64_SIZE, hi_get_milli_seconds());
+    if (len > 0)
     {
-        // E53_IA1_Read_Data(&data);
-        temperature = max30205_read_template();
-        RunGPS(&lat, &lon);
-        app_msg = malloc(sizeof(app_msg_t));
-        cir_hs();
-        printf("temperature:%.2f \r\n", temperature);
-        printf("SENSOR:Heart_rate: %d\nSO2: %d\r\n",g_heart_rate,g_spo2);
-        if (temperature > 29.0 || g_heart_rate > 99) {
-            hi_io_set_func(HI_IO_NAME_GPIO_2, HI_IO_FUNC_GPIO_1_GPIO);
-            hi_gpio_set_dir(HI_GPIO_IDX_2, HI_GPIO_DIR_OUT);               
-            hi_gpio_set_ouput_val(HI_GPIO_IDX_2, HI_GPIO_VALUE1);       
-        } else {
-            hi_io_set_func(HI_IO_NAME_GPIO_2, HI_IO_FUNC_GPIO_1_GPIO);
-            hi_gpio_set_dir(HI_GPIO_IDX_2, HI_GPIO_DIR_OUT);         
-            hi_gpio_set_ouput_val(HI_GPIO_IDX_2, HI_GPIO_VALUE0); 
-        }
-        if (NULL != app_msg)
+        msgup.device_id = NULL;
+        msgup.name = "track";
+        msgup.id = NULL;
+        msgup.msg = buf;
+        msgup.msg_len = len;
+        if (0 == oc_mqtt_profile_msgup(NULL, &msgup))
         {
-            app_msg->msg_type = en_msg_report;
-            app_msg->msg.report.temp = (float)temperature;
-            app_msg->msg.report.heart_rate = g_heart_rate;
-            app_msg->msg.report.spo2 = g_spo2;
-            app_msg->msg.report.lat = lat;
-            app_msg->msg.report.lon = lon;
-            if (0 != osMessageQueuePut(mid_MsgQueue, &app_msg, 0U, 0U))
-            {
-                free(app_msg);
-            }
+            gps_track_commit(hi_get_milli_seconds());
         }
-        osDelay(500);
     }
-    return 0;
 }
 
+/***********************************************************************
+* 函数名称: on_geofence_event
+* 说    明: 区域引擎事件回调（传感器任务中执行），把事件放入消息队列
+* 参    数: evt - 区域事件
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void on_geofence_event(const geofence_event_t *evt, void *arg)
+{
+    app_msg_t *app_msg;
+
+    (void)arg;
+    app_msg = app_msg_alloc(en_msg_geofence);
+    if (NULL == app_msg)
+    {
+        return;
+    }
+    app_msg->msg.geofence = *evt;
+    (void)app_msg_post(app_msg);
+}
 
 /***********************************************************************
-* 函数名称: OC_Demo
-* 说    明: 应用程序主入口，创建主任务与传感器任务
-* 参    数: 无
+* 函数名称: on_fall_button
+* 说    明: 摔倒按键回调（按键任务中执行），附带最新定位经告警快速通道发送，
+*           发送失败时放入关键通道由主任务补发
+* 参    数: fallen - 1 摔倒，0 恢复
+*           isr_ms - 按键中断时刻
+*           arg - 未使用
 * 返 回 值: 无
 ************************************************************************/
-static void OC_Demo(void)
+static void on_fall_button(int fallen, uint32_t isr_ms, void *arg)
+{
+    app_msg_t *app_msg;
+    gps_snapshot_t gps;
+    alarm_t alarm;
+
+    (void)arg;
+    device_shadow_set_int(SHADOW_FALL_STATUS, fallen);
+    alarm.fallen = fallen;
+    alarm.isr_ms = isr_ms;
+    gps_get_snapshot(&gps);
+    alarm.has_location = (gps.track.state != GPS_TRACK_NONE);
+    alarm.lat_e7 = gps.track.lat_e7;
+    alarm.lon_e7 = gps.track.lon_e7;
+    // 直接在按键任务中发送，不排在主任务正在处理的上报与命令之后
+    if (0 == alarm_send(&alarm))
+    {
+        return;
+    }
+    app_msg = app_msg_alloc(en_msg_alarm);
+    if (NULL == app_msg)
+    {
+        return;
+    }
+    app_msg->msg.alarm = alarm;
+    (void)app_msg_post(app_msg);
+}
+
+/***********************************************************************
+* 函数名称: parse_geofence_zone
+* 说    明: 解析 Geofence_Set 命令参数：
+*           {"id":1,"name":"site","type":"polygon","dwell":300,
+*            "points":[[lat,lon],...]}，圆形为 "type":"circle"、一个点和 "radius"（米）
+* 参    数: paras - 命令参数对象
+*           def - 输出区域定义
+* 返 回 值: 0 成功，-1 参数错误
+************************************************************************/
+static int parse_geofence_zone(cJSON *paras, geofence_zone_def_t *def)
+{
+    cJSON *item;
+    cJSON *point;
+    int count = 0;
+
+    memset(def, 0, sizeof(*def));
+    item = cJSON_GetObjectItem(paras, "id");
+    if (!cJSON_IsNumber(item))
+    {
+        return -1;
+    }
+    def->id = (uint16_t)item->valueint;
+    item = cJSON_GetObjectItem(paras, "name");
+    if (cJSON_IsString(item))
+    {
+        strncpy(def->name, item->valuestring, sizeof(def->name) - 1);
+    }
+    item = cJSON_GetObjectItem(paras, "dwell");
+    if (cJSON_IsNumber(item))
+    {
+        def->dwell_s = (uint16_t)item->valueint;
+    }
+    item = cJSON_GetObjectItem(paras, "type");
+    def->shape = (cJSON_IsString(item) && 0 == strcmp(item->valuestring, "circle")) ? GEOFENCE_CIRCLE : GEOFENCE_POLYGON;
+    item = cJSON_GetObjectItem(paras, "radius");
+    if (cJSON_IsNumber(item))
+    {
+        def->radius_m = (uint32_t)item->valueint;
+    }
+    cJSON_ArrayForEach(point, cJSON_GetObjectItem(paras, "points"))
+    {
+        if (count >= GEOFENCE_MAX_VERTICES || cJSON_GetArraySize(point) != 2)
+        {
+            return -1;
+        }
+        def->lat_e7[count] = (int32_t)(cJSON_GetArrayItem(point, 0)->valuedouble * 1e7);
+        def->lon_e7[count] = (int32_t)(cJSON_GetArrayItem(point, 1)->valuedouble * 1e7);
+        count++;
+    }
+    def->count = (uint8_t)count;
+    return (count > 0) ? 0 : -1;
+}
+
+/***********************************************************************
+* 函数名称: on_oc_downlink
+* 说    明: 接收到平台下行消息（命令、属性设置等）后的回调函数（MQTT 任务中执行）。
+*           消息内容指向 MQTT 接收缓存，返回后即被覆盖，因此把内容与请求 ID 拷贝到命令缓存池
+* 参    数: rcv - 按下行主题解析出的消息类型、请求 ID 与内容
+* 返 回 值: 0
+************************************************************************/
+static int on_oc_downlink(oc_mqtt_profile_msgrcv_t *rcv)
 {
-    mid_MsgQueue = osMessageQueueNew(MSGQUEUE_OBJECTS, 10, NULL);
-    if (mid_MsgQueue == NULL)
+    app_msg_t *app_msg;
+    char *payload;
+    size_t recv_size = (size_t)rcv->msg_len;
+
+    printf("recv data is %.*s\n", rcv->msg_len, (const char *)rcv->msg);
+    if (recv_size >= CMD_PAYLOAD_LEN ||
+        (NULL != rcv->request_id && strlen(rcv->request_id) >= CMD_REQUEST_ID_LEN))
+    {
+        g_msg_drops[en_msg_cmd]++;
+        return 0;
+    }
+    payload = mem_pool_alloc(&g_cmd_pool);
+    if (NULL == payload)
+    {
+        g_msg_drops[en_msg_cmd]++;
+        return 0;
+    }
+    app_msg = app_msg_alloc(en_msg_cmd);
+    if (NULL == app_msg)
+    {
+        mem_pool_free(&g_cmd_pool, payload);
+        return 0;
+    }
+    memcpy(payload, rcv->msg, recv_size);
+    payload[recv_size] = '\0';
+    app_msg->msg.cmd.type = (int)rcv->type;
+    app_msg->msg.cmd.request_id[0] = '\0';
+    if (NULL != rcv->request_id)
+    {
+        strcpy(app_msg->msg.cmd.request_id, rcv->request_id);
+    }
+    app_msg->msg.cmd.payload = payload;
+    (void)app_msg_post(app_msg);
+    return 0;
+}
+
+
+/***********************************************************************
+* 结构体名称: 命令参数
+* 说    明: 各命令校验后的参数，由命令注册表按 g_cmd_defs 中的声明填写
+************************************************************************/
+typedef struct
+{
+    int32_t on;
+} cmd_onoff_args_t;
+
+typedef struct
+{
+    int32_t id;
+} cmd_geofence_args_t;
+
+typedef struct
+{
+    int32_t level;
+} cmd_cooling_args_t;
+
+typedef struct
+{
+    int32_t period_s;
+} cmd_report_rate_args_t;
+
+/***********************************************************************
+* 函数名称: cmd_light
+* 说    明: 开关补光灯，{"Light":"ON"|"OFF"}
+* 参    数: args - cmd_onoff_args_t
+*           paras - 未使用
+* 返 回 值: CMD_RET_OK
+************************************************************************/
+static int cmd_light(const void *args, const cJSON *paras)
+{
+    (void)paras;
+    g_app_cb.led = ((const cmd_onoff_args_t *)args)->on;
+    device_shadow_set_int(SHADOW_LED, g_app_cb.led);
+    return CMD_RET_OK;
+}
+
+/***********************************************************************
+* 函数名称: cmd_motor
+* 说    明: 开关电机，{"Motor":"ON"|"OFF"}
+* 参    数: args - cmd_onoff_args_t
+*           paras - 未使用
+* 返 回 值: CMD_RET_OK
+************************************************************************/
+static int cmd_motor(const void *args, const cJSON *paras)
+{
+    (void)paras;
+    g_app_cb.motor = ((const cmd_onoff_args_t *)args)->on;
+    device_shadow_set_int(SHADOW_MOTOR, g_app_cb.motor);
+    return CMD_RET_OK;
+}
+
+/***********************************************************************
+* 函数名称: cmd_geofence_set
+* 说    明: 新增或替换区域，参数格式见 parse_geofence_zone
+* 参    数: args - cmd_geofence_args_t，id 已校验
+*           paras - 区域定义
+* 返 回 值: CMD_RET_OK 成功，CMD_RET_BAD_PARAM 区域定义错误，CMD_RET_FAIL 区域表已满
+************************************************************************/
+static int cmd_geofence_set(const void *args, const cJSON *paras)
+{
+    geofence_zone_def_t zone_def;
+
+    (void)args;
+    if (0 != parse_geofence_zone((cJSON *)paras, &zone_def))
+    {
+        return CMD_RET_BAD_PARAM;
+    }
+    return (0 == geofence_add(&zone_def)) ? CMD_RET_OK : CMD_RET_FAIL;
+}
+
+/***********************************************************************
+* 函数名称: cmd_geofence_delete
+* 说    明: 删除区域，{"id":n}，id 为 0 时删除全部区域
+* 参    数: args - cmd_geofence_args_t
+*           paras - 未使用
+* 返 回 值: CMD_RET_OK
+************************************************************************/
+static int cmd_geofence_delete(const void *args, const cJSON *paras)
+{
+    (void)paras;
+    geofence_remove((uint16_t)((const cmd_geofence_args_t *)args)->id);
+    return CMD_RET_OK;
+}
+
+/***********************************************************************
+* 函数名称: cmd_cooling_level
+* 说    明: 设置降温占空比，{"level":0~100}，-1 恢复自动控制
+* 参    数: args - cmd_cooling_args_t
+*           paras - 未使用
+* 返 回 值: CMD_RET_OK 成功，CMD_RET_FAIL 失败
+************************************************************************/
+static int cmd_cooling_level(const void *args, const cJSON *paras)
+{
+    (void)paras;
+    return (0 == cooling_set_level(((const cmd_cooling_args_t *)args)->level)) ? CMD_RET_OK : CMD_RET_FAIL;
+}
+
+/***********************************************************************
+* 函数名称: cmd_report_rate
+* 说    明: 设置属性上报周期，{"period":秒}。与属性设置 Report_period 相同，保存到参数表
+* 参    数: args - cmd_report_rate_args_t
+*           paras - 未使用
+* 返 回 值: CMD_RET_OK 成功，CMD_RET_FAIL 参数保存失败
+************************************************************************/
+static int cmd_report_rate(const void *args, const cJSON *paras)
+{
+    (void)paras;
+    param_store_begin();
+    if (0 != param_store_stage(param_store_name(PARAM_REPORT_PERIOD),
+                               ((const cmd_report_rate_args_t *)args)->period_s))
+    {
+        return CMD_RET_BAD_PARAM;
+    }
+    return (param_store_commit() >= 0) ? CMD_RET_OK : CMD_RET_FAIL;
+}
+
+/***********************************************************************
+* 函数名称: cmd_alarm_ack
+* 说    明: 平台确认已处理摔倒告警，不再补发保留的告警
+* 参    数: args - 无参数
+*           paras - 未使用
+* 返 回 值: CMD_RET_OK
+************************************************************************/
+static int cmd_alarm_ack(const void *args, const cJSON *paras)
+{
+    (void)args;
+    (void)paras;
+    g_alarm_pending_valid = 0;
+    printf("[alarm] acknowledged, fallen=%d\n", fall_button_is_fallen());
+    return CMD_RET_OK;
+}
+
+static const cmd_param_t g_light_params[] =
+{
+    { "Light", CMD_PARAM_ONOFF, 1, offsetof(cmd_onoff_args_t, on), 0, 0, NULL },
+};
+static const cmd_param_t g_motor_params[] =
+{
+    { "Motor", CMD_PARAM_ONOFF, 1, offsetof(cmd_onoff_args_t, on), 0, 0, NULL },
+};
+static const cmd_param_t g_geofence_params[] =
+{
+    { "id", CMD_PARAM_INT, 1, offsetof(cmd_geofence_args_t, id), 0, UINT16_MAX, NULL },
+};
+static const cmd_param_t g_cooling_params[] =
+{
+    { "level", CMD_PARAM_INT, 1, offsetof(cmd_cooling_args_t, level), COOLING_LEVEL_AUTO, 100, NULL },
+};
+static const cmd_param_t g_report_rate_params[] =
+{
+    { "period", CMD_PARAM_INT, 1, offsetof(cmd_report_rate_args_t, period_s), 1, 3600, NULL },
+};
+
+#define CMD_DEF(name, params, args, handler) \
+    { name, params, sizeof(params) / sizeof(cmd_param_t), sizeof(args), handler }
+
+// 平台下发的命令，新增命令只需在此声明参数并注册处理函数
+static const cmd_def_t g_cmd_defs[] =
+{
+    CMD_DEF("Agriculture_Control_light", g_light_params, cmd_onoff_args_t, cmd_light),
+    CMD_DEF("Agriculture_Control_Motor", g_motor_params, cmd_onoff_args_t, cmd_motor),
+    CMD_DEF("Geofence_Set", g_geofence_params, cmd_geofence_args_t, cmd_geofence_set),
+    CMD_DEF("Geofence_Delete", g_geofence_params, cmd_geofence_args_t, cmd_geofence_delete),
+    CMD_DEF("Cooling_Level", g_cooling_params, cmd_cooling_args_t, cmd_cooling_level),
+    CMD_DEF("Report_Rate", g_report_rate_params, cmd_report_rate_args_t, cmd_report_rate),
+    { "Alarm_Ack", NULL, 0, 0, cmd_alarm_ack },
+};
+
+/***********************************************************************
+* 函数名称: cmd_init
+* 说    明: 注册平台命令
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+static void cmd_init(void)
+{
+    for (unsigned int i = 0; i < sizeof(g_cmd_defs) / sizeof(g_cmd_defs[0]); i++)
+    {
+        if (0 != cmd_registry_register(&g_cmd_defs[i]))
+        {
+            printf("Falied to register command %s!\n", g_cmd_defs[i].name);
+        }
+    }
+}
+
+/***********************************************************************
+* 函数名称: shadow_set_param
+* 说    明: 把参数的当前取值写入影子
+* 参    数: id - 参数
+* 返 回 值: 无
+************************************************************************/
+static void shadow_set_param(param_id_t id)
+{
+    if (param_store_type(id) == PARAM_TYPE_FLOAT)
+    {
+        device_shadow_set_float(SHADOW_PARAM_BASE + id, param_get_float(id));
+    }
+    else
+    {
+        device_shadow_set_int(SHADOW_PARAM_BASE + id, param_get_int(id));
+    }
+}
+
+/***********************************************************************
+* 函数名称: shadow_init
+* 说    明: 初始化设备影子，写入启动时即已确定的参数与状态；
+*           传感器类属性在第一次得出结果前不出现在查询响应中
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+static void shadow_init(void)
+{
+    for (int i = 0; i < PARAM_MAX; i++)
+    {
+        g_shadow_defs[SHADOW_PARAM_BASE + i].service_id = "Agriculture";
+        g_shadow_defs[SHADOW_PARAM_BASE + i].key = param_store_name((param_id_t)i);
+        g_shadow_defs[SHADOW_PARAM_BASE + i].type =
+            (param_store_type((param_id_t)i) == PARAM_TYPE_FLOAT) ? SHADOW_TYPE_FLOAT : SHADOW_TYPE_INT;
+    }
+    if (0 != device_shadow_init(g_shadow_defs, SHADOW_PROP_MAX))
+    {
+        printf("Falied to init device shadow!\n");
+        return;
+    }
+    for (int i = 0; i < PARAM_MAX; i++)
+    {
+        shadow_set_param((param_id_t)i);
+    }
+    device_shadow_set_int(SHADOW_PARAM_VERSION, (int32_t)param_store_version());
+    device_shadow_set_int(SHADOW_LED, g_app_cb.led);
+    device_shadow_set_int(SHADOW_MOTOR, g_app_cb.motor);
+    device_shadow_set_int(SHADOW_FALL_STATUS, 0);
+}
+
+/***********************************************************************
+* 函数名称: on_param_changed
+* 说    明: 参数生效回调（提交修改的主任务中执行）。阈值类参数由各模块每周期读取，
+*           这里更新影子并处理需要重新配置的参数
+* 参    数: id - 变化的参数
+* 返 回 值: 无
+************************************************************************/
+static void on_param_changed(param_id_t id)
+{
+    shadow_set_param(id);
+    device_shadow_set_int(SHADOW_PARAM_VERSION, (int32_t)param_store_version());
+    switch (id)
+    {
+    case PARAM_REPORT_PERIOD:
+        (void)sensor_sched_set_period(g_report_job, (uint32_t)param_get_int(PARAM_REPORT_PERIOD) * 1000U);
+        break;
+    default:
+        break;
+    }
+}
+
+/***********************************************************************
+* 函数名称: deal_command
+* 说    明: 处理平台下发的命令：按命令名在注册表中查找，校验参数后执行，结果码随命令响应返回
+* 参    数: cmd - 指向命令结构体
+* 返 回 值: 无
+************************************************************************/
+static void deal_command(cmd_t *cmd)
+{
+    cJSON *obj_root;
+    int cmdret = CMD_RET_BAD_PARAM;
+    oc_mqtt_profile_cmdresp_t cmdresp;
+
+    obj_root = cJSON_Parse(cmd->payload);
+    if (NULL != obj_root)
+    {
+        cmdret = cmd_registry_dispatch(cJSON_GetStringValue(cJSON_GetObjectItem(obj_root, "command_name")),
+                                       cJSON_GetObjectItem(obj_root, "paras"));
+        cJSON_Delete(obj_root);
+    }
+
+    ///< do the response
+    cmdresp.paras = NULL;
+    cmdresp.request_id = (cmd->request_id[0] != '\0') ? cmd->request_id : NULL;
+    cmdresp.ret_code = cmdret;
+    cmdresp.ret_name = NULL;
+    (void)oc_mqtt_profile_cmdresp(NULL, &cmdresp);
+    return;
+}
+
+/***********************************************************************
+* 函数名称: deal_property_set
+* 说    明: 处理平台属性设置：{"services":[{"service_id":..,"properties":{"Cooling_temp_on":30,..}}]}。
+*           全部属性校验通过后才一次提交（版本号加一、写入 flash、立即生效），任一错误则都不修改。
+*           可带 "Param_version" 要求与当前版本一致，防止基于旧参数集的修改覆盖其他修改
+* 参    数: cmd - 指向下行消息结构体
+* 返 回 值: 无
+************************************************************************/
+static void deal_property_set(cmd_t *cmd)
+{
+    char description[64];
+    cJSON *obj_root;
+    cJSON *service;
+    cJSON *prop;
+    oc_mqtt_profile_propertysetresp_t resp;
+    int ret;
+
+    resp.ret_code = 1;
+    resp.ret_description = "invalid payload";
+    obj_root = cJSON_Parse(cmd->payload);
+    if (NULL != obj_root)
+    {
+        param_store_begin();
+        resp.ret_code = 0;
+        cJSON_ArrayForEach(service, cJSON_GetObjectItem(obj_root, "services"))
+        {
+            cJSON_ArrayForEach(prop, cJSON_GetObjectItem(service, "properties"))
+            {
+                if (!cJSON_IsNumber(prop))
+                {
+                    ret = -2;
+                }
+                else if (0 == strcasecmp(prop->string, "Param_version"))
+                {
+                    ret = (prop->valuedouble == (double)param_store_version()) ? 0 : -3;
+                }
+                else
+                {
+                    ret = param_store_stage(prop->string, prop->valuedouble);
+                }
+                if (ret != 0)
+                {
+                    (void)snprintf(description, sizeof(description), "%s %.32s",
+                                   (ret == -1) ? "unknown" : (ret == -3) ? "stale version" : "invalid",
+                                   prop->string);
+                    resp.ret_code = 1;
+                    resp.ret_description = description;
+                    break;
+                }
+            }
+            if (resp.ret_code != 0)
+            {
+                break;
+            }
+        }
+        cJSON_Delete(obj_root);
+        if (resp.ret_code == 0 && param_store_commit() < 0)
+        {
+            resp.ret_code = 1;
+            resp.ret_description = "persist failed";
+        }
+    }
+    if (resp.ret_code == 0)
+    {
+        resp.ret_description = NULL;
+    }
+    else
+    {
+        printf("[param] set rejected: %s\n", resp.ret_description);
+    }
+    resp.request_id = (cmd->request_id[0] != '\0') ? cmd->request_id : NULL;
+    (void)oc_mqtt_profile_propertysetresp(NULL, &resp);
+}
+
+/***********************************************************************
+* 函数名称: deal_property_get
+* 说    明: 处理平台属性查询：{"service_id":"Agriculture"}，service_id 可省略。
+*           直接以设备影子中的最新结果响应，不读取传感器
+* 参    数: cmd - 指向下行消息结构体
+* 返 回 值: 无
+************************************************************************/
+static void deal_property_get(cmd_t *cmd)
+{
+    cJSON *obj_root;
+
+    if (cmd->request_id[0] == '\0')
+    {
+        printf("[shadow] property get without request id\n");
+        return;
+    }
+    obj_root = cJSON_Parse(cmd->payload);
+    (void)device_shadow_respond(cmd->request_id,
+                                cJSON_GetStringValue(cJSON_GetObjectItem(obj_root, "service_id")));
+    cJSON_Delete(obj_root);
+}
+
+/***********************************************************************
+* 函数名称: deal_cmd_msg
+* 说    明: 按下行主题类型处理平台消息
+* 参    数: cmd - 指向下行消息结构体
+* 返 回 值: 无
+************************************************************************/
+static void deal_cmd_msg(cmd_t *cmd)
+{
+    switch (cmd->type)
+    {
+    case EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_COMMANDS:
+        deal_command(cmd);
+        break;
+    case EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_PROPERTYSET:
+        deal_property_set(cmd);
+        break;
+    case EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_PROPERTYGET:
+        deal_property_get(cmd);
+        break;
+    default:
+        printf("[cmd] downlink type %d ignored\n", cmd->type);
+        break;
+    }
+}
+
+/***********************************************************************
+* 函数名称: main_timer_cb
+* 说    明: 主任务周期定时器回调（定时器任务中执行），只置事件标志
+* 参    数: arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void main_timer_cb(void *arg)
+{
+    (void)arg;
+    g_timer_post_ms = hi_get_milli_seconds();
+    power_mgr_set_deadline(POWER_SRC_MAIN, g_timer_post_ms + g_main_period_ms);
+    (void)osEventFlagsSet(g_main_events, MAIN_EVT_TIMER);
+}
+
+/***********************************************************************
+* 函数名称: on_conn_changed
+* 说    明: 平台连接状态变化回调，只置事件标志，由主任务处理
+* 参    数: connected - 1 已连接，0 已断开
+* 返 回 值: 无
+************************************************************************/
+static void on_conn_changed(int connected)
+{
+    (void)connected;
+    g_conn_post_ms = hi_get_milli_seconds();
+    (void)osEventFlagsSet(g_main_events, MAIN_EVT_CONN);
+}
+
+/***********************************************************************
+* 函数名称: deal_app_msg
+* 说    明: 按消息类型分发处理，处理完释放消息
+* 参    数: app_msg - 消息
+* 返 回 值: 无
+************************************************************************/
+static void deal_app_msg(app_msg_t *app_msg)
+{
+    uint32_t start_ms = hi_get_milli_seconds();
+
+    switch (app_msg->msg_type)
+    {
+    case en_msg_cmd:    //如果获取到cmd的消息，就调用cmd消息处理函数
+        deal_cmd_msg(&app_msg->msg.cmd);
+        break;
+    case en_msg_report: //如果获取到report消息，就对数据进行上报处理
+        deal_report_msg(&app_msg->msg.report);
+        break;
+    case en_msg_geofence:
+        deal_geofence_msg(&app_msg->msg.geofence);
+        break;
+    case en_msg_alarm:
+        deal_alarm_msg(&app_msg->msg.alarm);
+        break;
+    default:
+        break;
+    }
+    if (app_msg->msg_type < en_msg_max)
+    {
+        dispatch_record(app_msg->msg_type, app_msg->post_ms, start_ms);
+    }
+    app_msg_free(app_msg);
+}
+
+/***********************************************************************
+* 函数名称: deal_timer_tick
+* 说    明: 主任务周期工作：检查连接、上传轨迹、打印分发统计。
+*           断线时按退避间隔重连，重连成功经 MAIN_EVT_CONN 补发告警与全量快照；
+*           一次重连阻塞主任务到 TCP 连接与 CONNACK 结束，期间消息留在各通道中
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+static void deal_timer_tick(void)
+{
+    static uint32_t last_stats_ms = 0;
+    static uint32_t retry_ms = 0;
+    static uint32_t retry_wait_ms = MAIN_RECONNECT_MIN_MS;
+    uint32_t now_ms = hi_get_milli_seconds();
+    int connected;
+
+    connected = oc_mqtt_is_connected();     // 心跳失败等断线在这里发现，经 MAIN_EVT_CONN 处理
+    if (connected)
+    {
+        retry_ms = now_ms;
+        retry_wait_ms = MAIN_RECONNECT_MIN_MS;
+    }
+    else if (now_ms - retry_ms >= retry_wait_ms)
+    {
+        connected = (oc_mqtt_reconnect() == 0);
+        now_ms = hi_get_milli_seconds();
+        retry_ms = now_ms;
+        if (!connected)
+        {
+            retry_wait_ms = (retry_wait_ms * 2 > MAIN_RECONNECT_MAX_MS) ? MAIN_RECONNECT_MAX_MS : retry_wait_ms * 2;
+            printf("[main] reconnect failed, retry in %u s\n", (unsigned)(retry_wait_ms / 1000));
+        }
+    }
+    if (connected && gps_track_due(now_ms))
+    {
+        deal_track_upload();
+    }
+    if (now_ms - last_stats_ms >= MAIN_STATS_MS)
+    {
+        last_stats_ms = now_ms;
+        dispatch_print_stats();
+    }
+}
+
+/***********************************************************************
+* 函数名称: task_main_entry
+* 说    明: 任务主线程，阻塞等待事件标志（消息到达、定时器到期、连接变化），
+*           没有事件时让出 CPU 给采样与空闲休眠
+* 参    数: 无
+* 返 回 值: 0（不退出）
+************************************************************************/
+static int task_main_entry(void)
+{
+    app_msg_t *app_msg;
+    osTimerId_t timer;
+    uint32_t main_ticks;
+    uint32_t flags;
+    uint32_t start_ms;
+
+    uint32_t ret = WifiConnect("harmony", "harmony@11");   //需要设置连接WIFI
+
+    // 连上 AP 后打开 Wi-Fi 省电，射频按 DTIM 间隔醒来，芯片才能在空闲时睡眠
+    (void)power_mgr_wifi_ps(1);
+    // 室内等长时间没有 GPS 授时时用 SNTP 校时，在低优先级任务中阻塞请求，不占用主任务
+    if (0 != time_service_start_sntp())
+    {
+        printf("Falied to start sntp task!\n");
+    }
+
+    device_info_init(CLIENT_ID, USERNAME, PASSWORD);    //配置设备信息
+    oc_set_conn_cb(on_conn_changed);
+    oc_mqtt_init(); //初始化oc_mqtt
+    oc_set_profile_rcv_cb(on_oc_downlink);    //设置平台下行消息的回调函数
+
+    // 定时器周期与发布给功耗管理的唤醒时刻由同一个节拍数得出
+    main_ticks = main_ms_to_ticks(MAIN_TICK_MS);
+    g_main_period_ms = (uint32_t)((uint64_t)main_ticks * 1000 / osKernelGetTickFreq());
+    timer = osTimerNew(main_timer_cb, osTimerPeriodic, NULL, NULL);
+    if (timer == NULL || osTimerStart(timer, main_ticks) != osOK)
+    {
+        printf("Falied to create main timer!\n");
+    }
+    power_mgr_set_deadline(POWER_SRC_MAIN, hi_get_milli_seconds() + g_main_period_ms);
+
+    while (1)
+    {
+        flags = osEventFlagsWait(g_main_events, MAIN_EVT_ALL, osFlagsWaitAny, osWaitForever);
+        if (flags & osFlagsError)
+        {
+            continue;
+        }
+        if (flags & MAIN_EVT_CONN)
+        {
+            start_ms = hi_get_milli_seconds();
+            g_app_cb.connected = oc_mqtt_is_connected();
+            if (g_app_cb.connected)
+            {
+                g_report_full = 1;  // 断线期间平台上的属性可能已过期
+                // 断线期间之后又有告警经快速通道送达时，保留的告警已过期，不再补发
+                if (g_alarm_pending_valid && g_alarm_pending.fallen == fall_button_is_fallen())
+                {
+                    deal_alarm_msg(&g_alarm_pending);
+                }
+                else
+                {
+                    g_alarm_pending_valid = 0;
+                }
+            }
+            printf("[main] platform %s\n", g_app_cb.connected ? "connected" : "disconnected");
+            dispatch_record(DISPATCH_CONN, g_conn_post_ms, start_ms);
+        }
+        if (flags & MAIN_EVT_MSG)
+        {
+            // 标志在等待返回时已清除，这里取空所有通道，之后入队的消息会重新置位；
+            // 每处理完一条都从关键通道重新开始取，高优先级消息不会排在积压的上报之后
+            while (NULL != (app_msg = app_msg_take()))
+            {
+                deal_app_msg(app_msg);
+            }
+        }
+        if (flags & MAIN_EVT_TIMER)
+        {
+            start_ms = hi_get_milli_seconds();
+            deal_timer_tick();
+            dispatch_record(DISPATCH_TIMER, g_timer_post_ms, start_ms);
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 结构体名称: sensor_state_t
+* 说    明: 传感器作业之间共享的状态，只在传感器任务中访问
+************************************************************************/
+typedef struct
+{
+    temp_filter_t temp_filter;
+    float temperature;
+    float temp_predict;
+    uint32_t last_location_ms;
+    int32_t lat_e7;             // 最近一次上报的位置（1e-7 度）
+    int32_t lon_e7;
+    int speed_cms;
+    int heading;
+} sensor_state_t;
+static sensor_state_t g_sensor;
+
+/***********************************************************************
+* 函数名称: job_ppg
+* 说    明: 心率/血氧采样作业，按 MAX30102 采样间隔运行
+* 参    数: now_ms - 调度时刻
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void job_ppg(uint32_t now_ms, void *arg)
+{
+    static int last_heart_rate = -1;
+    static int last_spo2 = -1;
+    shadow_value_t values[2];
+
+    (void)now_ms;
+    (void)arg;
+    max30102_app_sample();
+    // 采样频率高，只在心率/血氧结果变化时写入影子
+    if (g_heart_rate != last_heart_rate || g_spo2 != last_spo2)
+    {
+        last_heart_rate = g_heart_rate;
+        last_spo2 = g_spo2;
+        values[0].i = g_heart_rate;
+        values[1].i = g_spo2;
+        device_shadow_update(SHADOW_HEART_RATE, values, 2);
+    }
+}
+
+/***********************************************************************
+* 函数名称: job_temp
+* 说    明: 体温采样作业：读取 MAX30205，滤波并预测短时体温
+* 参    数: now_ms - 调度时刻
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void job_temp(uint32_t now_ms, void *arg)
+{
+    shadow_value_t values[3];
+
+    (void)arg;
+    g_sensor.temperature = max30205_read_template();
+    temp_filter_update(&g_sensor.temp_filter, g_sensor.temperature, now_ms);
+    g_sensor.temp_predict = temp_filter_predict(&g_sensor.temp_filter, TEMP_PREDICT_HORIZON_S);
+    printf("temperature:%.2f filtered:%.2f rate:%.2f/min predict:%.2f \r\n", g_sensor.temperature,
+           g_sensor.temp_filter.temp, temp_filter_rate_per_min(&g_sensor.temp_filter), g_sensor.temp_predict);
+    values[0].f = (float)g_sensor.temp_filter.temp;
+    values[1].f = (float)temp_filter_rate_per_min(&g_sensor.temp_filter);
+    values[2].f = g_sensor.temp_predict;
+    device_shadow_update(SHADOW_TEMP, values, 3);
+}
+
+/***********************************************************************
+* 函数名称: job_gps
+* 说    明: 位置作业：读取最新定位快照并更新电子围栏
+* 参    数: now_ms - 调度时刻
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void job_gps(uint32_t now_ms, void *arg)
+{
+    gps_snapshot_t gps;
+    gps_ttff_t ttff;
+    shadow_value_t values[4];
+
+    (void)arg;
+    // 定位由 GpsTask 持续解析并滤波，这里只读取最新快照，不会阻塞在串口上
+    gps_get_snapshot(&gps);
+    if (gps.track.state == GPS_TRACK_TRACKING)
+    {
+        geofence_update(gps.track.lat_e7, gps.track.lon_e7, now_ms);
+    }
+    if (gps.track.state != GPS_TRACK_NONE)
+    {
+        values[0].i = gps.track.lat_e7;
+        values[1].i = gps.track.lon_e7;
+        values[2].i = (int32_t)(gps.track.speed_ms * 100.0f);
+        values[3].i = (int32_t)gps.track.heading;
+        device_shadow_update(SHADOW_LAT, values, 4);
+    }
+    gps_aiding_get_ttff(&ttff);
+    device_shadow_set_int(SHADOW_GPS_TTFF, (int32_t)ttff.ttff_ms);
+}
+
+/***********************************************************************
+* 函数名称: job_cooling
+* 说    明: 降温控制输入作业：把预测体温与心率交给降温任务，心率升高时唤醒 GPS
+* 参    数: now_ms - 调度时刻
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void job_cooling(uint32_t now_ms, void *arg)
+{
+    cooling_stats_t cooling;
+    shadow_value_t values[2];
+
+    (void)now_ms;
+    (void)arg;
+    // 心率升高说明佩戴者在活动，让 GPS 从周期/待机模式立即恢复连续定位
+    if (g_heart_rate > GPS_PWR_ACTIVITY_HR) {
+        gps_power_notify_activity();
+    }
+    cooling_set_input(g_sensor.temp_predict, g_heart_rate);
+    cooling_get_stats(&cooling);
+    values[0].i = cooling.duty;
+    values[1].i = (int32_t)cooling.energy_mwh;
+    device_shadow_update(SHADOW_COOLING_DUTY, values, 2);
+}
+
+/***********************************************************************
+* 函数名称: job_report
+* 说    明: 上报作业：汇总各传感器的最新结果放入消息队列，
+*           位置仅在距上次带位置上报超过 LOCATION_HEARTBEAT_MS 时附带
+* 参    数: now_ms - 调度时刻
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void job_report(uint32_t now_ms, void *arg)
+{
+    app_msg_t *app_msg;
+    gps_snapshot_t gps;
+    gps_ttff_t ttff;
+    alarm_pub_stats_t alarm;
+    cooling_stats_t cooling;
+    power_stats_t power;
+    uint32_t total_ms;
+    int sleep_pct;
+    int has_location = 0;
+
+    (void)arg;
+    printf("SENSOR:Heart_rate: %d\nSO2: %d\r\n", g_heart_rate, g_spo2);
+    gps_get_snapshot(&gps);
+    if (gps.track.state != GPS_TRACK_NONE &&
+        (g_sensor.last_location_ms == 0 || now_ms - g_sensor.last_location_ms >= LOCATION_HEARTBEAT_MS))
+    {
+        has_location = 1;
+        g_sensor.last_location_ms = now_ms;
+        g_sensor.lat_e7 = gps.track.lat_e7;
+        g_sensor.lon_e7 = gps.track.lon_e7;
+        g_sensor.speed_cms = (int)(gps.track.speed_ms * 100.0f);
+        g_sensor.heading = (int)gps.track.heading;
+    }
+    app_msg = app_msg_alloc(en_msg_report);
+    if (NULL == app_msg)
+    {
+        return;
+    }
+    app_msg->msg.report.temp = (float)g_sensor.temp_filter.temp;
+    app_msg->msg.report.temp_rate = temp_filter_rate_per_min(&g_sensor.temp_filter);
+    app_msg->msg.report.temp_predict = g_sensor.temp_predict;
+    app_msg->msg.report.heart_rate = g_heart_rate;
+    app_msg->msg.report.spo2 = g_spo2;
+    app_msg->msg.report.has_location = has_location;
+    app_msg->msg.report.lat_e7 = g_sensor.lat_e7;
+    app_msg->msg.report.lon_e7 = g_sensor.lon_e7;
+    app_msg->msg.report.speed_cms = g_sensor.speed_cms;
+    app_msg->msg.report.heading = g_sensor.heading;
+    gps_aiding_get_ttff(&ttff);
+    app_msg->msg.report.gps_ttff = (int)ttff.ttff_ms;
+    alarm_pub_get_stats(&alarm);
+    app_msg->msg.report.alarm_count = (int)alarm.sent;
+    app_msg->msg.report.alarm_latency_max = (int)alarm.total_max_ms;
+    alarm_pub_format_hist(app_msg->msg.report.alarm_hist, sizeof(app_msg->msg.report.alarm_hist));
+    cooling_get_stats(&cooling);
+    app_msg->msg.report.cooling_duty = cooling.duty;
+    app_msg->msg.report.cooling_energy = (int)cooling.energy_mwh;
+    app_msg->msg.report.param_version = (int)param_store_version();
+    power_mgr_get_stats(&power);
+    total_ms = power.residency_ms[POWER_STATE_ACTIVE] + power.residency_ms[POWER_STATE_LIGHT] +
+               power.residency_ms[POWER_STATE_DEEP];
+    sleep_pct = (total_ms > 0) ?
+                (int)((uint64_t)(total_ms - power.residency_ms[POWER_STATE_ACTIVE]) * 100 / total_ms) : 0;
+    app_msg->msg.report.sleep_pct = sleep_pct;
+    device_shadow_set_int(SHADOW_SLEEP_PCT, sleep_pct);
+    app_msg->msg.report.sample_ms = now_ms;
+    (void)app_msg_post(app_msg);
+}
+
+/***********************************************************************
+* 函数名称: job_stats
+* 说    明: 定期打印调度统计
+* 参    数: now_ms - 调度时刻
+*           arg - 未使用
+* 返 回 值: 无
+************************************************************************/
+static void job_stats(uint32_t now_ms, void *arg)
+{
+    (void)now_ms;
+    (void)arg;
+    sensor_sched_print_stats();
+    cooling_print_stats();
+    device_shadow_print_stats();
+    power_mgr_print_stats();
+    gps_power_print_stats();
+    gps_print_stats();
+}
+
+/***********************************************************************
+* 函数名称: task_sensor_entry
+* 说    明: 传感器数据采集任务。各子系统以作业形式按各自周期注册到调度器，
+*           相位错开，互不等待
+* 参    数: 无
+* 返 回 值: 0（不退出）
+************************************************************************/
+static int task_sensor_entry(void)
+{
+    memset(&g_sensor, 0, sizeof(g_sensor));
+    temp_filter_init(&g_sensor.temp_filter);
+    max30205_init(); // 初始化温度传感器
+    max30102_app_setup();
+    printf("初始化完成\n");
+    UartExampleEntry();
+    geofence_init(on_geofence_event, NULL);
+    if (0 != cooling_init())
+    {
+        printf("Falied to init cooling!\n");
+    }
+    printf("初始化定位成功\n");
+    if (0 != fall_button_init(on_fall_button, NULL))
+    {
+        printf("Falied to init fall button!\n");
+    }
+
+    (void)sensor_sched_add("ppg", SENSOR_PPG_PERIOD_MS, 0, job_ppg, NULL);
+    (void)sensor_sched_add("temp", SENSOR_TEMP_PERIOD_MS, 5, job_temp, NULL);
+    (void)sensor_sched_add("gps", SENSOR_GPS_PERIOD_MS, 15, job_gps, NULL);
+    (void)sensor_sched_add("cooling", SENSOR_COOLING_PERIOD_MS, 25, job_cooling, NULL);
+    g_report_job = sensor_sched_add("report", (uint32_t)param_get_int(PARAM_REPORT_PERIOD) * 1000U, 35,
+                                    job_report, NULL);
+    (void)sensor_sched_add("stats", SENSOR_STATS_PERIOD_MS, SENSOR_STATS_PERIOD_MS, job_stats, NULL);
+    sensor_sched_run();
+    return 0;
+}
+
+
+/***********************************************************************
+* 函数名称: OC_Demo
+* 说    明: 应用程序主入口，创建主任务与传感器任务
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+static void OC_Demo(void)
+{
+    nv_store_init();
+    (void)param_store_init(on_param_changed);
+    shadow_init();
+    if (0 != power_mgr_init())
+    {
+        printf("Falied to init power manager!\n");
+    }
+    time_service_init();
+    cmd_init();
+    if (0 != alarm_pub_init(USERNAME, "Agriculture"))
+    {
+        printf("Falied to init alarm publisher!\n");
+    }
+    g_main_events = osEventFlagsNew(NULL);
+    if (g_main_events == NULL)
+    {
+        printf("Falied to create main event flags!\n");
+    }
+    mem_pool_init(&g_msg_pool, g_msg_blocks, sizeof(app_msg_t), MSGQUEUE_OBJECTS);
+    mem_pool_init(&g_cmd_pool, g_cmd_blocks, CMD_PAYLOAD_LEN, CMD_PAYLOAD_SLOTS);
+    if (0 != msg_lane_init(&g_lanes[LANE_CRITICAL], "critical", MSGQUEUE_OBJECTS) ||
+        0 != msg_lane_init(&g_lanes[LANE_COMMAND], "command", CMD_PAYLOAD_SLOTS) ||
+        0 != msg_lane_init(&g_lanes[LANE_TELEMETRY], "telemetry", TELEMETRY_LANE_DEPTH))
     {
-        printf("Falied to create Message Queue!\n");
+        printf("Falied to create message lanes!\n");
     }
 
     osThreadAttr_t attr;
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "oc_mqtt.h"
+#include "time_service.h"
+#include "nmea_parser.h"
+#include "alarm_pub.h"
+
+#define ALARM_PUB_TOPIC_FMT     "$oc/devices/%s/sys/properties/report"
+#define ALARM_PUB_TIME_WIDTH    (TIME_EVENT_TIME_LEN - 1)
+#define ALARM_PUB_STATUS_WIDTH  6       // "FALL" 含引号
+#define ALARM_PUB_COORD_WIDTH   12      // "-180.0000000"
+
+/*
+ * 告警报文在初始化时按固定宽度生成一次，发送时只改写各字段所在的字节：
+ * 字段不足宽度的部分以空格补齐，没有时间或位置时整段改写为空格，都是合法的 JSON 空白，
+ * 发送路径上没有 cJSON 建树、序列化与堆分配
+ */
+static char g_topic[ALARM_PUB_TOPIC_LEN];
+static char g_template[ALARM_PUB_PAYLOAD_LEN];
+static char g_payload[ALARM_PUB_PAYLOAD_LEN];
+static int g_payload_len = 0;
+static int g_off_time;          // "event_time":"…", 整段
+static int g_len_time;
+static int g_off_time_val;
+static int g_off_status;
+static int g_off_loc;           // ,"Lat":…,"Lon":… 整段
+static int g_len_loc;
+static int g_off_lat;
+static int g_off_lon;
+static osMutexId_t g_mutex = NULL;
+static alarm_pub_stats_t g_stats;
+
+static const uint32_t g_hist_bound[ALARM_PUB_HIST_BUCKETS] =
+{
+    50, 100, 200, 300, 500, 1000, 2000, UINT32_MAX
+};
+
+/***********************************************************************
+* 函数名称: alarm_pub_patch
+* 说    明: 把文本写入报文的定宽字段，不足部分补空格
+* 参    数: off：字段偏移
+*           width：字段宽度
+*           text：文本，超出宽度部分截断
+*           right：1 右对齐（数值），0 左对齐（字符串）
+* 返 回 值: 无
+************************************************************************/
+static void alarm_pub_patch(int off, int width, const char *text, int right)
+{
+    int len = (int)strlen(text);
+
+    if (len > width) {
+        len = width;
+    }
+    memset(&g_payload[off], ' ', width);
+    memcpy(&g_payload[off + (right ? width - len : 0)], text, len);
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_init
+* 说    明: 生成告警主题与报文模板，记录各字段偏移
+* 参    数: device_id：设备 ID
+*           service_id：服务 ID
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int alarm_pub_init(const char *device_id, const char *service_id)
+{
+    int len = 0;
+    int n;
+
+    n = snprintf(g_topic, sizeof(g_topic), ALARM_PUB_TOPIC_FMT, device_id);
+    if (n < 0 || n >= (int)sizeof(g_topic)) {
+        return -1;
+    }
+
+#define ALARM_PUB_APPEND(...) \
+    do { \
+        n = snprintf(&g_template[len], sizeof(g_template) - len, __VA_ARGS__); \
+        if (n < 0 || n >= (int)sizeof(g_template) - len) { \
+            return -1; \
+        } \
+        len += n; \
+    } while (0)
+
+    ALARM_PUB_APPEND("{\"services\":[{");
+    g_off_time = len;
+    ALARM_PUB_APPEND("\"event_time\":\"");
+    g_off_time_val = len;
+    ALARM_PUB_APPEND("%*s\",", ALARM_PUB_TIME_WIDTH, "");
+    g_len_time = len - g_off_time;
+    ALARM_PUB_APPEND("\"service_id\":\"%s\",\"properties\":{\"FallStatus\":", service_id);
+    g_off_status = len;
+    ALARM_PUB_APPEND("%*s", ALARM_PUB_STATUS_WIDTH, "");
+    g_off_loc = len;
+    ALARM_PUB_APPEND(",\"Lat\":");
+    g_off_lat = len;
+    ALARM_PUB_APPEND("%*s,\"Lon\":", ALARM_PUB_COORD_WIDTH, "");
+    g_off_lon = len;
+    ALARM_PUB_APPEND("%*s", ALARM_PUB_COORD_WIDTH, "");
+    g_len_loc = len - g_off_loc;
+    ALARM_PUB_APPEND("}}]}");
+#undef ALARM_PUB_APPEND
+
+    g_payload_len = len;
+    memset(&g_stats, 0, sizeof(g_stats));
+    if (g_mutex == NULL) {
+        g_mutex = osMutexNew(NULL);
+        if (g_mutex == NULL) {
+            printf("[alarm] Failed to create mutex!\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_record
+* 说    明: 记录一次成功发送的各阶段时延
+* 参    数: isr_ms：按键中断时刻
+*           pub_ms：开始发送时刻
+*           ack_ms：收到 PUBACK 时刻
+* 返 回 值: 无
+************************************************************************/
+static void alarm_pub_record(uint32_t isr_ms, uint32_t pub_ms, uint32_t ack_ms)
+{
+    uint32_t total = ack_ms - isr_ms;
+    int i;
+
+    for (i = 0; total > g_hist_bound[i]; i++) {
+    }
+    g_stats.hist[i]++;
+    g_stats.sent++;
+    g_stats.last_ms = total;
+    if (total > g_stats.total_max_ms) {
+        g_stats.total_max_ms = total;
+    }
+    if (pub_ms - isr_ms > g_stats.isr_to_pub_max_ms) {
+        g_stats.isr_to_pub_max_ms = pub_ms - isr_ms;
+    }
+    if (ack_ms - pub_ms > g_stats.pub_to_ack_max_ms) {
+        g_stats.pub_to_ack_max_ms = ack_ms - pub_ms;
+    }
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_send
+* 说    明: 改写报文字段后立即以 QoS 1 发布，由调用任务直接发送，不经过主任务消息队列。
+*           MQTTPublish 在收到 PUBACK 后才返回，返回时刻即确认时刻
+* 参    数: fallen：1 摔倒，0 恢复
+*           isr_ms：按键中断时刻，同时作为 event_time
+*           lat_e7/lon_e7：位置，NULL 表示不带位置
+* 返 回 值: 0 平台已确认，-1 未连接或发送失败
+************************************************************************/
+int alarm_pub_send(int fallen, uint32_t isr_ms, const int32_t *lat_e7, const int32_t *lon_e7)
+{
+    char text[TIME_EVENT_TIME_LEN];
+    uint32_t pub_ms;
+    uint32_t ack_ms;
+    int ret;
+
+    if (g_payload_len == 0) {
+        return -1;
+    }
+    osMutexAcquire(g_mutex, osWaitForever);
+    if (!oc_mqtt_is_connected()) {
+        g_stats.failed++;
+        osMutexRelease(g_mutex);
+        return -1;
+    }
+    pub_ms = hi_get_milli_seconds();
+    memcpy(g_payload, g_template, g_payload_len + 1);
+    // 未校时前整段去掉 event_time，由平台按到达时间打戳
+    if (time_service_format(isr_ms, text, sizeof(text)) == 0) {
+        alarm_pub_patch(g_off_time_val, ALARM_PUB_TIME_WIDTH, text, 0);
+    } else {
+        memset(&g_payload[g_off_time], ' ', g_len_time);
+    }
+    alarm_pub_patch(g_off_status, ALARM_PUB_STATUS_WIDTH, fallen ? "\"FALL\"" : "\"OK\"", 0);
+    if (lat_e7 != NULL && lon_e7 != NULL) {
+        (void)nmea_format_e7(*lat_e7, text, sizeof(text));
+        alarm_pub_patch(g_off_lat, ALARM_PUB_COORD_WIDTH, text, 1);
+        (void)nmea_format_e7(*lon_e7, text, sizeof(text));
+        alarm_pub_patch(g_off_lon, ALARM_PUB_COORD_WIDTH, text, 1);
+    } else {
+        memset(&g_payload[g_off_loc], ' ', g_len_loc);
+    }
+
+    ret = oc_mqtt_publish(g_topic, (uint8_t *)g_payload, g_payload_len, (int)en_mqtt_al_qos_1);
+    ack_ms = hi_get_milli_seconds();
+    if (ret == 0) {
+        alarm_pub_record(isr_ms, pub_ms, ack_ms);
+    } else {
+        g_stats.failed++;
+    }
+    osMutexRelease(g_mutex);
+    return ret;
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_hist_bound
+* 说    明: 获取直方图桶的时延上限
+* 参    数: bucket：桶序号
+* 返 回 值: 上限（毫秒），最后一个桶为 UINT32_MAX
+************************************************************************/
+uint32_t alarm_pub_hist_bound(int bucket)
+{
+    return g_hist_bound[bucket];
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_format_hist
+* 说    明: 把时延直方图格式化为逗号分隔的各桶计数，如 "0,3,1,0,0,0,0,0"，
+*           桶上限依次为 alarm_pub_hist_bound(0..ALARM_PUB_HIST_BUCKETS-1)
+* 参    数: buf：输出缓冲区
+*           size：缓冲区长度，建议 ALARM_PUB_HIST_STR_LEN
+* 返 回 值: 写入的长度，缓冲区不足时截断到最后一个完整的桶
+************************************************************************/
+int alarm_pub_format_hist(char *buf, int size)
+{
+    int len = 0;
+
+    if (size <= 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+    for (int i = 0; i < ALARM_PUB_HIST_BUCKETS; i++) {
+        int n = snprintf(buf + len, (size_t)(size - len), (i == 0) ? "%u" : ",%u", (unsigned)g_stats.hist[i]);
+        if (n < 0 || n >= size - len) {
+            buf[len] = '\0';
+            break;
+        }
+        len += n;
+    }
+    return len;
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_get_stats
+* 说    明: 获取告警发送统计
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void alarm_pub_get_stats(alarm_pub_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
+
+/***********************************************************************
+* 函数名称: alarm_pub_print_stats
+* 说    明: 打印告警时延直方图
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void alarm_pub_print_stats(void)
+{
+    printf("[alarm] sent=%u failed=%u last=%u max=%u ms (isr->pub %u, pub->ack %u) hist",
+           (unsigned)g_stats.sent, (unsigned)g_stats.failed, (unsigned)g_stats.last_ms,
+           (unsigned)g_stats.total_max_ms, (unsigned)g_stats.isr_to_pub_max_ms,
+           (unsigned)g_stats.pub_to_ack_max_ms);
+    for (int i = 0; i < ALARM_PUB_HIST_BUCKETS - 1; i++) {
+        printf(" <=%u:%u", (unsigned)g_hist_bound[i], (unsigned)g_stats.hist[i]);
+    }
+    printf(" >%u:%u\n", (unsigned)g_hist_bound[ALARM_PUB_HIST_BUCKETS - 2],
+           (unsigned)g_stats.hist[ALARM_PUB_HIST_BUCKETS - 1]);
+}
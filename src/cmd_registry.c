@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "hi_time.h"
+#include "cmd_registry.h"
+
+#define CMD_FNV_OFFSET      2166136261U
+#define CMD_FNV_PRIME       16777619U
+
+/*
+ * 开放寻址散列表，命令名的 FNV-1a 散列值决定起始槽，冲突时线性探测。
+ * 命令只在启动时注册，注册时记录最长探测距离，查找不会超过该距离
+ */
+typedef struct
+{
+    const cmd_def_t *def;
+    uint32_t hash;
+    cmd_stats_t stats;
+} cmd_slot_t;
+
+static cmd_slot_t g_slots[CMD_REGISTRY_SLOTS];
+static uint8_t g_max_probe = 0;
+static uint8_t g_count = 0;
+static uint32_t g_unknown = 0;
+
+/***********************************************************************
+* 函数名称: cmd_registry_hash
+* 说    明: 计算命令名的 FNV-1a 散列值
+* 参    数: name：命令名
+* 返 回 值: 32 位散列值
+************************************************************************/
+uint32_t cmd_registry_hash(const char *name)
+{
+    uint32_t hash = CMD_FNV_OFFSET;
+
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= CMD_FNV_PRIME;
+    }
+    return hash;
+}
+
+/***********************************************************************
+* 函数名称: cmd_registry_register
+* 说    明: 注册命令，只在启动时调用
+* 参    数: def：命令定义，需在运行期间保持有效
+* 返 回 值: 0 成功，-1 重名、参数结构体过大或散列表已满
+************************************************************************/
+int cmd_registry_register(const cmd_def_t *def)
+{
+    uint32_t hash = cmd_registry_hash(def->name);
+
+    if (def->args_size > CMD_ARGS_MAX || g_count >= CMD_REGISTRY_SLOTS / 2) {
+        return -1;
+    }
+    for (uint8_t probe = 0; probe < CMD_REGISTRY_SLOTS; probe++) {
+        cmd_slot_t *slot = &g_slots[(hash + probe) & (CMD_REGISTRY_SLOTS - 1)];
+        if (slot->def == NULL) {
+            slot->def = def;
+            slot->hash = hash;
+            memset(&slot->stats, 0, sizeof(slot->stats));
+            if (probe > g_max_probe) {
+                g_max_probe = probe;
+            }
+            g_count++;
+            return 0;
+        }
+        if (slot->hash == hash && 0 == strcmp(slot->def->name, def->name)) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/***********************************************************************
+* 函数名称: cmd_registry_find
+* 说    明: 按命令名查找槽位
+* 参    数: name：命令名
+* 返 回 值: 槽位，未注册返回 NULL
+************************************************************************/
+static cmd_slot_t *cmd_registry_find(const char *name)
+{
+    uint32_t hash = cmd_registry_hash(name);
+
+    for (uint8_t probe = 0; probe <= g_max_probe; probe++) {
+        cmd_slot_t *slot = &g_slots[(hash + probe) & (CMD_REGISTRY_SLOTS - 1)];
+        if (slot->def == NULL) {
+            break;
+        }
+        if (slot->hash == hash && 0 == strcmp(slot->def->name, name)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/***********************************************************************
+* 函数名称: cmd_registry_parse
+* 说    明: 按参数声明校验参数对象，并写入参数结构体
+* 参    数: def：命令定义
+*           paras：参数对象，可为 NULL
+*           args：参数结构体，调用前已清零
+* 返 回 值: 0 成功，-1 参数错误
+************************************************************************/
+static int cmd_registry_parse(const cmd_def_t *def, const cJSON *paras, uint8_t *args)
+{
+    for (uint8_t i = 0; i < def->param_count; i++) {
+        const cmd_param_t *param = &def->params[i];
+        const cJSON *item = (paras != NULL) ? cJSON_GetObjectItem(paras, param->name) : NULL;
+        int32_t value = 0;
+
+        if (item == NULL) {
+            if (param->required) {
+                printf("[cmd] %s: missing %s\n", def->name, param->name);
+                return -1;
+            }
+            continue;
+        }
+        switch (param->type) {
+        case CMD_PARAM_INT:
+            if (!cJSON_IsNumber(item) || item->valuedouble < param->min || item->valuedouble > param->max) {
+                break;
+            }
+            value = (int32_t)item->valuedouble;
+            memcpy(args + param->offset, &value, sizeof(value));
+            continue;
+        case CMD_PARAM_ONOFF:
+            if (!cJSON_IsString(item)) {
+                break;
+            }
+            if (0 == strcasecmp(item->valuestring, "ON")) {
+                value = 1;
+            } else if (0 != strcasecmp(item->valuestring, "OFF")) {
+                break;
+            }
+            memcpy(args + param->offset, &value, sizeof(value));
+            continue;
+        case CMD_PARAM_ENUM:
+            if (!cJSON_IsString(item)) {
+                break;
+            }
+            for (value = 0; param->names[value] != NULL; value++) {
+                if (0 == strcasecmp(item->valuestring, param->names[value])) {
+                    break;
+                }
+            }
+            if (param->names[value] == NULL) {
+                break;
+            }
+            memcpy(args + param->offset, &value, sizeof(value));
+            continue;
+        case CMD_PARAM_STRING:
+            if (!cJSON_IsString(item) || strlen(item->valuestring) >= CMD_PARAM_STR_MAX) {
+                break;
+            }
+            strcpy((char *)(args + param->offset), item->valuestring);
+            continue;
+        default:
+            break;
+        }
+        printf("[cmd] %s: invalid %s\n", def->name, param->name);
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: cmd_registry_dispatch
+* 说    明: 查找命令，校验参数后调用处理函数，并记录耗时
+* 参    数: name：命令名
+*           paras：参数对象，可为 NULL
+* 返 回 值: CMD_RET_*，或处理函数的非零返回值
+************************************************************************/
+int cmd_registry_dispatch(const char *name, const cJSON *paras)
+{
+    union
+    {
+        uint8_t bytes[CMD_ARGS_MAX];
+        int64_t align;
+    } args;
+    uint32_t start_ms = hi_get_milli_seconds();
+    cmd_slot_t *slot;
+    uint32_t run_ms;
+    int ret;
+
+    slot = (name != NULL) ? cmd_registry_find(name) : NULL;
+    if (slot == NULL) {
+        g_unknown++;
+        printf("[cmd] unknown command %s\n", (name != NULL) ? name : "(null)");
+        return CMD_RET_UNKNOWN;
+    }
+    memset(&args, 0, sizeof(args));
+    if (0 != cmd_registry_parse(slot->def, paras, args.bytes)) {
+        ret = CMD_RET_BAD_PARAM;
+    } else {
+        ret = slot->def->handler(args.bytes, paras);
+    }
+
+    run_ms = hi_get_milli_seconds() - start_ms;
+    slot->stats.count++;
+    slot->stats.run_total_ms += run_ms;
+    if (run_ms > slot->stats.run_max_ms) {
+        slot->stats.run_max_ms = run_ms;
+    }
+    if (ret != CMD_RET_OK) {
+        slot->stats.failed++;
+    }
+    return ret;
+}
+
+/***********************************************************************
+* 函数名称: cmd_registry_print_stats
+* 说    明: 打印各命令的执行次数与耗时
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void cmd_registry_print_stats(void)
+{
+    printf("[cmd] registered=%u max probe=%u unknown=%u\n", g_count, g_max_probe, (unsigned)g_unknown);
+    for (int i = 0; i < CMD_REGISTRY_SLOTS; i++) {
+        const cmd_slot_t *slot = &g_slots[i];
+        if (slot->def == NULL || slot->stats.count == 0) {
+            continue;
+        }
+        printf("[cmd] %s n=%u failed=%u run avg=%u max=%u ms\n", slot->def->name, (unsigned)slot->stats.count,
+               (unsigned)slot->stats.failed, (unsigned)(slot->stats.run_total_ms / slot->stats.count),
+               (unsigned)slot->stats.run_max_ms);
+    }
+}
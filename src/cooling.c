@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "hi_io.h"
+#include "hi_gpio.h"
+#include "hi_time.h"
+#include "param_store.h"
+#include "power_mgr.h"
+#include "cooling.h"
+
+#define COOLING_GPIO_IDX    HI_GPIO_IDX_2
+
+static volatile float g_temp_predict = 0.0f;    // 由传感器任务写入
+static volatile int g_heart_rate = 0;
+static volatile cooling_stats_t g_stats;
+static volatile int g_level = COOLING_LEVEL_AUTO;   // 平台下发的固定占空比
+static int g_active = 0;            // 滞回判断后的降温使能
+static float g_integral = 0.0f;     // 积分项（%）
+static uint32_t g_carry_ms = 0;     // 短于最短吸合时间、顺延到下一周期的吸合时间
+static int g_output = 0;
+static uint32_t g_on_since_ms = 0;
+
+/***********************************************************************
+* 函数名称: cooling_ms_to_ticks
+* 说    明: 毫秒转换为系统节拍，至少 1 个节拍
+* 参    数: ms：毫秒
+* 返 回 值: 节拍数
+************************************************************************/
+static uint32_t cooling_ms_to_ticks(uint32_t ms)
+{
+    uint32_t ticks = (uint32_t)(((uint64_t)ms * osKernelGetTickFreq() + 999) / 1000);
+
+    return ticks > 0 ? ticks : 1;
+}
+
+/***********************************************************************
+* 函数名称: cooling_wait
+* 说    明: 发布下一次切换时刻后阻塞等待，空闲期间按该时刻选择睡眠深度
+* 参    数: ms：等待时间
+* 返 回 值: 无
+************************************************************************/
+static void cooling_wait(uint32_t ms)
+{
+    power_mgr_set_deadline(POWER_SRC_COOLING, hi_get_milli_seconds() + ms);
+    osDelay(cooling_ms_to_ticks(ms));
+}
+
+/***********************************************************************
+* 函数名称: cooling_output
+* 说    明: 设置继电器输出，只在状态变化时写 GPIO 并统计吸合次数与时间
+* 参    数: on：1 吸合，0 释放
+* 返 回 值: 无
+************************************************************************/
+static void cooling_output(int on)
+{
+    uint32_t now_ms = hi_get_milli_seconds();
+
+    if (on == g_output) {
+        return;
+    }
+    g_output = on;
+    hi_gpio_set_ouput_val(COOLING_GPIO_IDX, on ? HI_GPIO_VALUE1 : HI_GPIO_VALUE0);
+    power_mgr_veto(POWER_VETO_COOLING, on);
+    if (on) {
+        g_on_since_ms = now_ms;
+        g_stats.switches++;
+    } else {
+        g_stats.on_ms += now_ms - g_on_since_ms;
+    }
+}
+
+/***********************************************************************
+* 函数名称: cooling_control
+* 说    明: 计算本周期占空比：预测体温或心率越限时开始降温，回落到回差以下且心率正常时停止；
+*           降温期间以 PI 控制按体温偏差给出占空比，心率过高时不低于 COOLING_HR_DUTY。
+*           阈值每周期从参数表读取，平台修改后下一周期生效
+* 参    数: temp：预测体温
+*           hr：心率
+*           dt_s：距上次计算的时间（秒）
+* 返 回 值: 占空比（0~100）
+************************************************************************/
+static int cooling_control(float temp, int hr, float dt_s)
+{
+    float temp_on = param_get_float(PARAM_COOLING_TEMP_ON);
+    float temp_off = temp_on - param_get_float(PARAM_COOLING_TEMP_HYST);
+    int hr_on = param_get_int(PARAM_COOLING_HR_ON);
+    float err;
+    float duty;
+    int level = g_level;
+
+    if (level != COOLING_LEVEL_AUTO) {
+        g_active = 0;           // 恢复自动控制时重新按滞回判断，积分从零开始
+        g_integral = 0.0f;
+        return level;
+    }
+    if (!g_active) {
+        g_active = (temp > temp_on || hr > hr_on);
+    } else if (temp < temp_off && hr <= hr_on) {
+        g_active = 0;
+        g_integral = 0.0f;
+        g_carry_ms = 0;
+    }
+    if (!g_active) {
+        return 0;
+    }
+
+    // 以停止降温的阈值为设定点，体温回落过程中占空比逐步减小
+    err = temp - temp_off;
+    g_integral += COOLING_KI * err * dt_s;
+    if (g_integral < 0.0f) {
+        g_integral = 0.0f;
+    } else if (g_integral > 100.0f) {
+        g_integral = 100.0f;      // 限幅防止积分饱和
+    }
+    duty = COOLING_KP * err + g_integral;
+    if (hr > hr_on && duty < COOLING_HR_DUTY) {
+        duty = COOLING_HR_DUTY;
+    }
+    if (duty < 0.0f) {
+        duty = 0.0f;
+    } else if (duty > 100.0f) {
+        duty = 100.0f;
+    }
+    return (int)(duty + 0.5f);
+}
+
+/***********************************************************************
+* 函数名称: cooling_task
+* 说    明: 时间比例输出：每 COOLING_WINDOW_MS 计算一次占空比，周期开始吸合、
+*           吸合时间到后释放，其余时间阻塞等待。短于 COOLING_MIN_SWITCH_MS 的吸合
+*           顺延累积到后续周期，接近满占空比时整周期保持吸合，减少继电器动作
+* 参    数: arg：未使用
+* 返 回 值: 无
+************************************************************************/
+static void cooling_task(void *arg)
+{
+    uint32_t last_ms = hi_get_milli_seconds();
+
+    (void)arg;
+    while (1) {
+        uint32_t now_ms = hi_get_milli_seconds();
+        int duty = cooling_control(g_temp_predict, g_heart_rate, (now_ms - last_ms) / 1000.0f);
+        uint32_t on_ms = (uint32_t)duty * COOLING_WINDOW_MS / 100 + g_carry_ms;
+
+        last_ms = now_ms;
+        g_stats.duty = duty;
+        g_carry_ms = 0;
+        if (on_ms < COOLING_MIN_SWITCH_MS && duty > 0) {
+            g_carry_ms = on_ms;
+            on_ms = 0;
+        } else if (on_ms + COOLING_MIN_SWITCH_MS > COOLING_WINDOW_MS) {
+            on_ms = COOLING_WINDOW_MS;
+        }
+
+        if (on_ms > 0) {
+            cooling_output(1);
+            cooling_wait(on_ms);
+        }
+        if (on_ms < COOLING_WINDOW_MS) {
+            cooling_output(0);
+            cooling_wait(COOLING_WINDOW_MS - on_ms);
+        }
+    }
+}
+
+/***********************************************************************
+* 函数名称: cooling_init
+* 说    明: 配置 GPIO2 为输出并保持释放，创建降温控制任务。引脚只在这里配置一次
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int cooling_init(void)
+{
+    osThreadAttr_t attr;
+
+    memset((void *)&g_stats, 0, sizeof(g_stats));
+    hi_gpio_init();
+    hi_io_set_func(HI_IO_NAME_GPIO_2, HI_IO_FUNC_GPIO_2_GPIO);
+    hi_gpio_set_dir(COOLING_GPIO_IDX, HI_GPIO_DIR_OUT);
+    hi_gpio_set_ouput_val(COOLING_GPIO_IDX, HI_GPIO_VALUE0);
+    g_output = 0;
+
+    attr.name = "cooling";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = COOLING_TASK_STACK;
+    attr.priority = COOLING_TASK_PRIO;
+    if (osThreadNew((osThreadFunc_t)cooling_task, NULL, &attr) == NULL) {
+        printf("[cooling] Failed to create cooling!\n");
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: cooling_set_input
+* 说    明: 更新控制输入，下一控制周期生效
+* 参    数: temp_predict：滤波后的预测体温
+*           heart_rate：心率
+* 返 回 值: 无
+************************************************************************/
+void cooling_set_input(float temp_predict, int heart_rate)
+{
+    g_temp_predict = temp_predict;
+    g_heart_rate = heart_rate;
+}
+
+/***********************************************************************
+* 函数名称: cooling_set_level
+* 说    明: 设置固定占空比或恢复自动控制，下一控制周期生效
+* 参    数: level：0~100 固定占空比，COOLING_LEVEL_AUTO 自动控制
+* 返 回 值: 0 成功，-1 参数错误
+************************************************************************/
+int cooling_set_level(int level)
+{
+    if (level != COOLING_LEVEL_AUTO && (level < 0 || level > 100)) {
+        return -1;
+    }
+    g_level = level;
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: cooling_get_level
+* 说    明: 获取当前控制方式
+* 参    数: 无
+* 返 回 值: 固定占空比，或 COOLING_LEVEL_AUTO
+************************************************************************/
+int cooling_get_level(void)
+{
+    return g_level;
+}
+
+/***********************************************************************
+* 函数名称: cooling_get_stats
+* 说    明: 获取降温控制统计，吸合中的时间计入累计吸合时间
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void cooling_get_stats(cooling_stats_t *stats)
+{
+    memcpy(stats, (const void *)&g_stats, sizeof(*stats));
+    if (g_output) {
+        stats->on_ms += hi_get_milli_seconds() - g_on_since_ms;
+    }
+    stats->energy_mwh = (uint32_t)((uint64_t)stats->on_ms * COOLING_LOAD_MW / 3600000U);
+}
+
+/***********************************************************************
+* 函数名称: cooling_print_stats
+* 说    明: 打印降温控制统计
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void cooling_print_stats(void)
+{
+    cooling_stats_t stats;
+
+    cooling_get_stats(&stats);
+    printf("[cooling] duty=%d%% switches=%u on=%u s energy=%u mWh\n", stats.duty,
+           (unsigned)stats.switches, (unsigned)(stats.on_ms / 1000), (unsigned)stats.energy_mwh);
+}
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "oc_mqtt.h"
+#include "device_shadow.h"
+
+/*
+ * 各处理阶段得出结果时写入影子，平台查询属性时只拷贝影子，不读传感器。
+ * 属性值都是 32 位，写入方来自传感器、主任务与按键任务，用互斥量保证
+ * 一组相关属性（如经纬度）一起更新、一起被查询拷贝
+ */
+static const shadow_def_t *g_defs = NULL;
+static uint8_t g_count = 0;
+static shadow_value_t g_values[SHADOW_PROPS_MAX];
+static uint32_t g_valid = 0;        // 按位标记已写入过的属性，未写入的不出现在响应中
+static osMutexId_t g_mutex = NULL;
+static shadow_stats_t g_stats;
+
+/***********************************************************************
+* 函数名称: device_shadow_init
+* 说    明: 初始化影子，所有属性标记为无数据
+* 参    数: defs：属性定义表，需在运行期间保持有效
+*           count：属性个数，不超过 SHADOW_PROPS_MAX
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int device_shadow_init(const shadow_def_t *defs, uint8_t count)
+{
+    if (count == 0 || count > SHADOW_PROPS_MAX) {
+        return -1;
+    }
+    g_mutex = osMutexNew(NULL);
+    if (g_mutex == NULL) {
+        printf("[shadow] Failed to create mutex!\n");
+        return -1;
+    }
+    g_defs = defs;
+    g_count = count;
+    g_valid = 0;
+    memset(g_values, 0, sizeof(g_values));
+    memset(&g_stats, 0, sizeof(g_stats));
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_update
+* 说    明: 更新连续的一组属性，查询时这组属性总是同一次更新的值
+* 参    数: id：第一个属性的序号
+*           values：取值，按属性类型填写 i 或 f
+*           count：属性个数
+* 返 回 值: 无
+************************************************************************/
+void device_shadow_update(uint8_t id, const shadow_value_t *values, uint8_t count)
+{
+    if (g_mutex == NULL || id + count > g_count) {
+        return;
+    }
+    (void)osMutexAcquire(g_mutex, osWaitForever);
+    for (uint8_t i = 0; i < count; i++) {
+        g_values[id + i] = values[i];
+        g_valid |= 1U << (id + i);
+    }
+    g_stats.updates++;
+    (void)osMutexRelease(g_mutex);
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_set_int
+* 说    明: 更新单个整数、经纬度或枚举属性
+* 参    数: id：属性序号
+*           value：取值
+* 返 回 值: 无
+************************************************************************/
+void device_shadow_set_int(uint8_t id, int32_t value)
+{
+    shadow_value_t v;
+
+    v.i = value;
+    device_shadow_update(id, &v, 1);
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_set_float
+* 说    明: 更新单个浮点属性
+* 参    数: id：属性序号
+*           value：取值
+* 返 回 值: 无
+************************************************************************/
+void device_shadow_set_float(uint8_t id, float value)
+{
+    shadow_value_t v;
+
+    v.f = value;
+    device_shadow_update(id, &v, 1);
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_enum_name
+* 说    明: 取枚举属性取值对应的字符串
+* 参    数: def：属性定义
+*           value：取值
+* 返 回 值: 字符串，取值越界时为空串
+************************************************************************/
+static const char *device_shadow_enum_name(const shadow_def_t *def, int32_t value)
+{
+    for (int32_t i = 0; def->names != NULL && def->names[i] != NULL; i++) {
+        if (i == value) {
+            return def->names[i];
+        }
+    }
+    return "";
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_respond
+* 说    明: 以影子中的当前值响应平台的属性查询，按服务分组，只包含已有数据的属性
+* 参    数: request_id：平台请求 ID
+*           service_id：只响应该服务，NULL 或空串响应全部服务（不区分大小写）
+* 返 回 值: 0 成功，-1 没有匹配的属性，其他为发送失败的错误码
+************************************************************************/
+int device_shadow_respond(char *request_id, const char *service_id)
+{
+    shadow_value_t values[SHADOW_PROPS_MAX];
+    union
+    {
+        int i;
+        int32_t e7;
+        double f;
+    } out[SHADOW_PROPS_MAX];
+    oc_mqtt_profile_kv_t kv[SHADOW_PROPS_MAX];
+    oc_mqtt_profile_service_t services[SHADOW_SERVICES_MAX];
+    oc_mqtt_profile_kv_t *tail[SHADOW_SERVICES_MAX];
+    oc_mqtt_profile_propertygetresp_t resp;
+    uint32_t start_ms = hi_get_milli_seconds();
+    uint32_t copy_us = hi_get_us();
+    uint32_t run_ms;
+    uint32_t valid;
+    int service_count = 0;
+    int ret;
+
+    if (g_mutex == NULL) {
+        return -1;
+    }
+    (void)osMutexAcquire(g_mutex, osWaitForever);
+    memcpy(values, g_values, sizeof(values[0]) * g_count);
+    valid = g_valid;
+    g_stats.gets++;
+    (void)osMutexRelease(g_mutex);
+    copy_us = hi_get_us() - copy_us;
+
+    if (service_id != NULL && service_id[0] == '\0') {
+        service_id = NULL;
+    }
+    memset(services, 0, sizeof(services));
+    for (uint8_t i = 0; i < g_count; i++) {
+        const shadow_def_t *def = &g_defs[i];
+        int s;
+
+        if (!(valid & (1U << i)) ||
+            (service_id != NULL && 0 != strcasecmp(service_id, def->service_id))) {
+            continue;
+        }
+        for (s = 0; s < service_count; s++) {
+            if (0 == strcmp(services[s].service_id, def->service_id)) {
+                break;
+            }
+        }
+        if (s == service_count) {
+            if (service_count >= SHADOW_SERVICES_MAX) {
+                continue;
+            }
+            services[s].service_id = (char *)def->service_id;
+            if (s > 0) {
+                services[s - 1].nxt = &services[s];
+            }
+            service_count++;
+        }
+
+        kv[i].nxt = NULL;
+        kv[i].key = (char *)def->key;
+        switch (def->type) {
+        case SHADOW_TYPE_FLOAT:
+            out[i].f = values[i].f;
+            kv[i].type = EN_OC_MQTT_PROFILE_VALUE_FLOAT;
+            kv[i].value = &out[i].f;
+            break;
+        case SHADOW_TYPE_E7:
+            out[i].e7 = values[i].i;
+            kv[i].type = EN_OC_MQTT_PROFILE_VALUE_E7;
+            kv[i].value = &out[i].e7;
+            break;
+        case SHADOW_TYPE_ENUM:
+            kv[i].type = EN_OC_MQTT_PROFILE_VALUE_STRING;
+            kv[i].value = (void *)device_shadow_enum_name(def, values[i].i);
+            break;
+        default:
+            out[i].i = (int)values[i].i;
+            kv[i].type = EN_OC_MQTT_PROFILE_VALUE_INT;
+            kv[i].value = &out[i].i;
+            break;
+        }
+        if (services[s].service_property == NULL) {
+            services[s].service_property = &kv[i];
+        } else {
+            tail[s]->nxt = &kv[i];
+        }
+        tail[s] = &kv[i];
+    }
+
+    if (service_count == 0) {
+        g_stats.no_match++;
+        printf("[shadow] no properties for service %s\n", (service_id != NULL) ? service_id : "(all)");
+        return -1;
+    }
+    resp.request_id = request_id;
+    resp.services = services;
+    ret = oc_mqtt_profile_propertygetresp(NULL, &resp);
+
+    run_ms = hi_get_milli_seconds() - start_ms;
+    (void)osMutexAcquire(g_mutex, osWaitForever);
+    if (ret == 0) {
+        g_stats.answered++;
+    }
+    if (copy_us > g_stats.copy_max_us) {
+        g_stats.copy_max_us = copy_us;
+    }
+    if (run_ms > g_stats.get_max_ms) {
+        g_stats.get_max_ms = run_ms;
+    }
+    (void)osMutexRelease(g_mutex);
+    return ret;
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_get_stats
+* 说    明: 获取影子统计
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void device_shadow_get_stats(shadow_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
+
+/***********************************************************************
+* 函数名称: device_shadow_print_stats
+* 说    明: 打印影子统计
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void device_shadow_print_stats(void)
+{
+    printf("[shadow] updates=%u gets=%u answered=%u no_match=%u copy max=%u us get max=%u ms\n",
+           (unsigned)g_stats.updates, (unsigned)g_stats.gets, (unsigned)g_stats.answered,
+           (unsigned)g_stats.no_match, (unsigned)g_stats.copy_max_us, (unsigned)g_stats.get_max_ms);
+}
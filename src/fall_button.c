@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "wifiiot_gpio.h"
+#include "wifiiot_gpio_ex.h"
+#include "power_mgr.h"
+#include "fall_button.h"
+
+#define FALL_BUTTON_EVT_F1      0x01U   // GPIO11，摔倒
+#define FALL_BUTTON_EVT_F2      0x02U   // GPIO12，恢复
+#define FALL_BUTTON_EVT_ALL     (FALL_BUTTON_EVT_F1 | FALL_BUTTON_EVT_F2)
+
+static osEventFlagsId_t g_button_events = NULL;
+static volatile uint32_t g_isr_ms[2];
+static volatile uint32_t g_isr_count = 0;
+static fall_button_stats_t g_stats;
+static fall_button_cb_t g_fall_cb = NULL;
+static void *g_fall_arg = NULL;
+static int g_fallen = 0;
+
+/*
+ * 中断服务函数只记录时间戳并置事件标志，打印、消抖、状态判断与上报都在按键任务中完成，
+ * 不延长中断关闭时间，不影响串口与 I2C 的中断响应
+ */
+static void fall_button_f1_isr(char *arg)
+{
+    (void)arg;
+    g_isr_ms[0] = hi_get_milli_seconds();
+    g_isr_count++;
+    power_mgr_veto(POWER_VETO_FALL_BUTTON, 1);
+    (void)osEventFlagsSet(g_button_events, FALL_BUTTON_EVT_F1);
+}
+
+static void fall_button_f2_isr(char *arg)
+{
+    (void)arg;
+    g_isr_ms[1] = hi_get_milli_seconds();
+    g_isr_count++;
+    power_mgr_veto(POWER_VETO_FALL_BUTTON, 1);
+    (void)osEventFlagsSet(g_button_events, FALL_BUTTON_EVT_F2);
+}
+
+/***********************************************************************
+* 函数名称: fall_button_pressed
+* 说    明: 复核按键电平（上拉输入，按下为低电平）
+* 参    数: gpio：GPIO 编号
+* 返 回 值: 1 仍处于按下状态，0 已释放
+************************************************************************/
+static int fall_button_pressed(WifiIotGpioIdx gpio)
+{
+    WifiIotGpioValue value = WIFI_IOT_GPIO_VALUE1;
+
+    (void)GpioGetInputVal(gpio, &value);
+    return value == WIFI_IOT_GPIO_VALUE0;
+}
+
+/***********************************************************************
+* 函数名称: fall_button_task
+* 说    明: 按键任务：等待中断事件，延时 FALL_BUTTON_DEBOUNCE_MS 后复核电平，
+*           期间的抖动中断被合并；状态变化时调用回调
+* 参    数: arg：未使用
+* 返 回 值: 无
+************************************************************************/
+static void fall_button_task(void *arg)
+{
+    uint32_t ticks = (FALL_BUTTON_DEBOUNCE_MS * osKernelGetTickFreq() + 999) / 1000;
+
+    (void)arg;
+    while (1) {
+        uint32_t flags = osEventFlagsWait(g_button_events, FALL_BUTTON_EVT_ALL, osFlagsWaitAny, osWaitForever);
+        if (flags & osFlagsError) {
+            continue;
+        }
+        osDelay(ticks > 0 ? ticks : 1);
+        flags |= osEventFlagsClear(g_button_events, FALL_BUTTON_EVT_ALL) & FALL_BUTTON_EVT_ALL;
+        g_stats.isr_count = g_isr_count;
+
+        for (int i = 0; i < 2; i++) {
+            if (!(flags & (1U << i))) {
+                continue;
+            }
+            int fallen = (i == 0);
+            if (!fall_button_pressed(fallen ? WIFI_IOT_GPIO_IDX_11 : WIFI_IOT_GPIO_IDX_12)) {
+                g_stats.bounces++;
+                continue;
+            }
+            if (fallen == g_fallen) {
+                g_stats.repeats++;
+                continue;
+            }
+            g_fallen = fallen;
+            g_stats.events++;
+            printf("[fall] %s\n", fallen ? "有人摔倒了" : "站起来了");
+            if (g_fall_cb != NULL) {
+                g_fall_cb(fallen, g_isr_ms[i], g_fall_arg);
+            }
+        }
+        // 告警已交给发送通道，解除否决；处理期间又有中断时事件标志仍在，恢复否决到下一轮
+        power_mgr_veto(POWER_VETO_FALL_BUTTON, 0);
+        if (osEventFlagsGet(g_button_events) & FALL_BUTTON_EVT_ALL) {
+            power_mgr_veto(POWER_VETO_FALL_BUTTON, 1);
+        }
+    }
+}
+
+/***********************************************************************
+* 函数名称: fall_button_init
+* 说    明: 配置 F1（GPIO11）/ F2（GPIO12）下降沿中断并创建按键任务
+* 参    数: cb：摔倒 / 恢复回调
+*           arg：回调参数
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int fall_button_init(fall_button_cb_t cb, void *arg)
+{
+    osThreadAttr_t attr;
+
+    if (g_button_events != NULL) {
+        return 0;
+    }
+    g_fall_cb = cb;
+    g_fall_arg = arg;
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_button_events = osEventFlagsNew(NULL);
+    if (g_button_events == NULL) {
+        printf("[fall] Failed to create event flags!\n");
+        return -1;
+    }
+
+    attr.name = "fall_button";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = FALL_BUTTON_TASK_STACK;
+    attr.priority = FALL_BUTTON_TASK_PRIO;
+    if (osThreadNew((osThreadFunc_t)fall_button_task, NULL, &attr) == NULL) {
+        printf("[fall] Failed to create fall_button!\n");
+        return -1;
+    }
+
+    GpioInit();
+    //初始化F1按键，设置为下降沿触发中断
+    IoSetFunc(WIFI_IOT_IO_NAME_GPIO_11, WIFI_IOT_IO_FUNC_GPIO_11_GPIO);
+    GpioSetDir(WIFI_IOT_GPIO_IDX_11, WIFI_IOT_GPIO_DIR_IN);
+    IoSetPull(WIFI_IOT_IO_NAME_GPIO_11, WIFI_IOT_IO_PULL_UP);
+    GpioRegisterIsrFunc(WIFI_IOT_GPIO_IDX_11, WIFI_IOT_INT_TYPE_EDGE, WIFI_IOT_GPIO_EDGE_FALL_LEVEL_LOW,
+                        fall_button_f1_isr, NULL);
+    //初始化F2按键，设置为下降沿触发中断
+    IoSetFunc(WIFI_IOT_IO_NAME_GPIO_12, WIFI_IOT_IO_FUNC_GPIO_12_GPIO);
+    GpioSetDir(WIFI_IOT_GPIO_IDX_12, WIFI_IOT_GPIO_DIR_IN);
+    IoSetPull(WIFI_IOT_IO_NAME_GPIO_12, WIFI_IOT_IO_PULL_UP);
+    GpioRegisterIsrFunc(WIFI_IOT_GPIO_IDX_12, WIFI_IOT_INT_TYPE_EDGE, WIFI_IOT_GPIO_EDGE_FALL_LEVEL_LOW,
+                        fall_button_f2_isr, NULL);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: fall_button_is_fallen
+* 说    明: 获取当前摔倒状态
+* 参    数: 无
+* 返 回 值: 1 摔倒，0 正常
+************************************************************************/
+int fall_button_is_fallen(void)
+{
+    return g_fallen;
+}
+
+/***********************************************************************
+* 函数名称: fall_button_get_stats
+* 说    明: 获取按键统计
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void fall_button_get_stats(fall_button_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+    stats->isr_count = g_isr_count;
+}
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "cmsis_os2.h"
+#include "geofence.h"
+
+#define GEOFENCE_M_PER_E7       0.011132f   // 纬度 1e-7 度对应的米数
+#define GEOFENCE_Q15            32768
+
+/*
+ * 编译期区域表，以 id 为 0 的项结束。坐标为 1e-7 度，例如：
+ * { 1, "site", GEOFENCE_POLYGON, 0, { 230001000, 230001000, 229990000, 229990000 },
+ *   { 1130000000, 1130012000, 1130012000, 1130000000 }, 4, 0 },
+ * { 2, "cooling-A", GEOFENCE_CIRCLE, 60, { 229995000 }, { 1130006000 }, 0, 15 },
+ */
+static const geofence_zone_def_t g_builtin_zones[] =
+{
+    { 0 },
+};
+
+/***********************************************************************
+* 结构体名称: geofence_zone_t
+* 说    明: 区域运行时状态，加载时预先计算包围盒与圆形判定参数
+************************************************************************/
+typedef struct
+{
+    geofence_zone_def_t def;
+    int32_t min_lat;
+    int32_t max_lat;
+    int32_t min_lon;
+    int32_t max_lon;
+    uint32_t r_e7;          // 圆形半径（1e-7 纬度）
+    int32_t cos_q15;        // 圆心纬度余弦（Q15），把经度差换算为等效纬度差
+    uint32_t enter_ms;
+    uint8_t used;
+    uint8_t inside;
+    uint8_t pending;        // 与当前状态相反的连续判定次数
+    uint8_t dwell_sent;
+} geofence_zone_t;
+
+static geofence_zone_t g_zones[GEOFENCE_MAX_ZONES];
+static geofence_event_cb_t g_event_cb = NULL;
+static void *g_event_arg = NULL;
+static osMutexId_t g_geofence_mutex = NULL;
+
+/***********************************************************************
+* 函数名称: geofence_prepare
+* 说    明: 计算区域包围盒与圆形判定参数
+* 参    数: z：区域
+* 返 回 值: 0 成功，-1 定义非法
+************************************************************************/
+static int geofence_prepare(geofence_zone_t *z)
+{
+    const geofence_zone_def_t *d = &z->def;
+
+    if (d->shape == GEOFENCE_CIRCLE) {
+        if (d->radius_m == 0) {
+            return -1;
+        }
+        z->r_e7 = (uint32_t)(d->radius_m / GEOFENCE_M_PER_E7);
+        z->cos_q15 = (int32_t)(cosf((float)d->lat_e7[0] * (float)(M_PI / 180.0 / 1e7)) * GEOFENCE_Q15);
+        if (z->cos_q15 < 1) {
+            z->cos_q15 = 1;
+        }
+        int32_t r_lon = (int32_t)(((int64_t)z->r_e7 * GEOFENCE_Q15) / z->cos_q15);
+        z->min_lat = d->lat_e7[0] - (int32_t)z->r_e7;
+        z->max_lat = d->lat_e7[0] + (int32_t)z->r_e7;
+        z->min_lon = d->lon_e7[0] - r_lon;
+        z->max_lon = d->lon_e7[0] + r_lon;
+        return 0;
+    }
+
+    if (d->shape != GEOFENCE_POLYGON || d->count < 3 || d->count > GEOFENCE_MAX_VERTICES) {
+        return -1;
+    }
+    z->min_lat = z->max_lat = d->lat_e7[0];
+    z->min_lon = z->max_lon = d->lon_e7[0];
+    for (int i = 1; i < d->count; i++) {
+        if (d->lat_e7[i] < z->min_lat) z->min_lat = d->lat_e7[i];
+        if (d->lat_e7[i] > z->max_lat) z->max_lat = d->lat_e7[i];
+        if (d->lon_e7[i] < z->min_lon) z->min_lon = d->lon_e7[i];
+        if (d->lon_e7[i] > z->max_lon) z->max_lon = d->lon_e7[i];
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: geofence_contains
+* 说    明: 判断点是否在区域内：先比较包围盒，再做整数圆形或射线法判定。
+*           射线法以包围盒左下角为原点，坐标差不超过区域跨度，叉积用 64 位不会溢出
+* 参    数: z：区域
+*           lat / lon：点（1e-7 度）
+* 返 回 值: 1 在区域内，0 不在
+************************************************************************/
+static int geofence_contains(const geofence_zone_t *z, int32_t lat, int32_t lon)
+{
+    const geofence_zone_def_t *d = &z->def;
+
+    if (lat < z->min_lat || lat > z->max_lat || lon < z->min_lon || lon > z->max_lon) {
+        return 0;
+    }
+    if (d->shape == GEOFENCE_CIRCLE) {
+        int64_t dy = (int64_t)lat - d->lat_e7[0];
+        int64_t dx = (((int64_t)lon - d->lon_e7[0]) * z->cos_q15) >> 15;
+        return dx * dx + dy * dy <= (int64_t)z->r_e7 * z->r_e7;
+    }
+
+    int inside = 0;
+    int64_t py = (int64_t)lat - z->min_lat;
+    int64_t px = (int64_t)lon - z->min_lon;
+    for (int i = 0, j = d->count - 1; i < d->count; j = i++) {
+        int64_t yi = (int64_t)d->lat_e7[i] - z->min_lat;
+        int64_t yj = (int64_t)d->lat_e7[j] - z->min_lat;
+        if ((yi > py) == (yj > py)) {
+            continue;
+        }
+        int64_t xi = (int64_t)d->lon_e7[i] - z->min_lon;
+        int64_t xj = (int64_t)d->lon_e7[j] - z->min_lon;
+        // px < xi + (xj - xi) * (py - yi) / (yj - yi)，两边同乘 (yj - yi) 并按其符号处理
+        int64_t lhs = (px - xi) * (yj - yi);
+        int64_t rhs = (xj - xi) * (py - yi);
+        if ((yj > yi) ? (lhs < rhs) : (lhs > rhs)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/***********************************************************************
+* 函数名称: geofence_init
+* 说    明: 初始化区域引擎并加载编译期区域表
+* 参    数: cb：事件回调，在调用 geofence_update 的任务中执行
+*           arg：回调参数
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int geofence_init(geofence_event_cb_t cb, void *arg)
+{
+    if (g_geofence_mutex == NULL) {
+        g_geofence_mutex = osMutexNew(NULL);
+        if (g_geofence_mutex == NULL) {
+            printf("[geofence] Failed to create mutex!\n");
+            return -1;
+        }
+    }
+    memset(g_zones, 0, sizeof(g_zones));
+    g_event_cb = cb;
+    g_event_arg = arg;
+    for (int i = 0; g_builtin_zones[i].id != 0; i++) {
+        geofence_add(&g_builtin_zones[i]);
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: geofence_add
+* 说    明: 添加区域，id 已存在时覆盖并重置其进出状态
+* 参    数: def：区域定义
+* 返 回 值: 0 成功，-1 定义非法或区域已满
+************************************************************************/
+int geofence_add(const geofence_zone_def_t *def)
+{
+    geofence_zone_t zone;
+    geofence_zone_t *slot = NULL;
+
+    if (def->id == 0) {
+        return -1;
+    }
+    memset(&zone, 0, sizeof(zone));
+    zone.def = *def;
+    zone.def.name[GEOFENCE_NAME_LEN - 1] = '\0';
+    if (zone.def.dwell_s == 0) {
+        zone.def.dwell_s = GEOFENCE_DEFAULT_DWELL_S;
+    }
+    if (geofence_prepare(&zone) != 0) {
+        printf("[geofence] zone %u rejected\n", def->id);
+        return -1;
+    }
+    zone.used = 1;
+
+    osMutexAcquire(g_geofence_mutex, osWaitForever);
+    for (int i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (g_zones[i].used && g_zones[i].def.id == def->id) {
+            slot = &g_zones[i];
+            break;
+        }
+        if (!g_zones[i].used && slot == NULL) {
+            slot = &g_zones[i];
+        }
+    }
+    if (slot != NULL) {
+        *slot = zone;
+    }
+    osMutexRelease(g_geofence_mutex);
+
+    if (slot == NULL) {
+        printf("[geofence] zone table full\n");
+        return -1;
+    }
+    printf("[geofence] zone %u \"%s\" loaded\n", zone.def.id, zone.def.name);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: geofence_remove
+* 说    明: 删除区域
+* 参    数: id：区域编号，0 表示删除全部
+* 返 回 值: 删除的区域数
+************************************************************************/
+int geofence_remove(uint16_t id)
+{
+    int removed = 0;
+
+    osMutexAcquire(g_geofence_mutex, osWaitForever);
+    for (int i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (g_zones[i].used && (id == 0 || g_zones[i].def.id == id)) {
+            g_zones[i].used = 0;
+            removed++;
+        }
+    }
+    osMutexRelease(g_geofence_mutex);
+    return removed;
+}
+
+/***********************************************************************
+* 函数名称: geofence_count
+* 说    明: 获取已加载的区域数
+* 参    数: 无
+* 返 回 值: 区域数
+************************************************************************/
+int geofence_count(void)
+{
+    int count = 0;
+
+    for (int i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        count += g_zones[i].used;
+    }
+    return count;
+}
+
+/***********************************************************************
+* 函数名称: geofence_update
+* 说    明: 用最新位置更新各区域进出状态，产生 enter / exit / dwell 事件；
+*           状态需连续 GEOFENCE_DEBOUNCE 次一致才切换，回调在释放锁后执行
+* 参    数: lat_e7 / lon_e7：当前位置（1e-7 度）
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+void geofence_update(int32_t lat_e7, int32_t lon_e7, uint32_t now_ms)
+{
+    geofence_event_t events[GEOFENCE_MAX_ZONES];
+    int count = 0;
+
+    osMutexAcquire(g_geofence_mutex, osWaitForever);
+    for (int i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        geofence_zone_t *z = &g_zones[i];
+        if (!z->used) {
+            continue;
+        }
+        geofence_event_t *evt = &events[count];
+        int inside = geofence_contains(z, lat_e7, lon_e7);
+
+        if (inside != z->inside) {
+            if (++z->pending < GEOFENCE_DEBOUNCE) {
+                continue;
+            }
+            z->pending = 0;
+            z->inside = (uint8_t)inside;
+            evt->type = inside ? GEOFENCE_EVT_ENTER : GEOFENCE_EVT_EXIT;
+            evt->dwell_s = inside ? 0 : (now_ms - z->enter_ms) / 1000;
+            z->enter_ms = now_ms;
+            z->dwell_sent = 0;
+        } else {
+            z->pending = 0;
+            if (!inside || z->dwell_sent || now_ms - z->enter_ms < z->def.dwell_s * 1000U) {
+                continue;
+            }
+            z->dwell_sent = 1;
+            evt->type = GEOFENCE_EVT_DWELL;
+            evt->dwell_s = (now_ms - z->enter_ms) / 1000;
+        }
+        evt->zone_id = z->def.id;
+        evt->lat_e7 = lat_e7;
+        evt->lon_e7 = lon_e7;
+        evt->time_ms = now_ms;
+        count++;
+    }
+    osMutexRelease(g_geofence_mutex);
+
+    for (int i = 0; i < count; i++) {
+        printf("[geofence] zone %u %s\n", events[i].zone_id, geofence_event_name(events[i].type));
+        if (g_event_cb != NULL) {
+            g_event_cb(&events[i], g_event_arg);
+        }
+    }
+}
+
+/***********************************************************************
+* 函数名称: geofence_event_name
+* 说    明: 事件类型名称，用于上报
+* 参    数: type：事件类型
+* 返 回 值: 名称字符串
+************************************************************************/
+const char *geofence_event_name(uint8_t type)
+{
+    switch (type) {
+        case GEOFENCE_EVT_ENTER:
+            return "enter";
+        case GEOFENCE_EVT_EXIT:
+            return "exit";
+        case GEOFENCE_EVT_DWELL:
+            return "dwell";
+        default:
+            return "unknown";
+    }
+}
@@ -10,10 +10,19 @@
 #include "hi_uart.h"
 #include "hi_watchdog.h"
 #include "hi_gpio.h"
-#include <sys/time.h>
-
-#define UART_BUFF_SIZE 1024
-#define U_SLEEP_TIME   700000
+#include "nmea_parser.h"
+#include "hi_time.h"
+#include "gps_uart.h"
+#include "gps_config.h"
+#include "gps_power.h"
+#include "gps_aiding.h"
+#include "gps_filter.h"
+#include "gps_track.h"
+#include "time_service.h"
+#include "gps.h"
+
+#define GPS_MAX_HDOP   5.0f     // HDOP 超过该值的定位视为精度不足，不发布
+#define GPS_READ_TIMEOUT_MS 1000
 
 /***********************************************************************
 * 函数名称: Uart1GpioInit
@@ -31,14 +40,14 @@ void Uart1GpioInit(void)
 /***********************************************************************
 * 函数名称: Uart1Config
 * 说    明: 配置 UART1 的串口参数，包括波特率、数据位等
-* 参    数: 无
+* 参    数: baud_rate：波特率
 * 返 回 值: 无
 ************************************************************************/
-void Uart1Config(void)
+void Uart1Config(uint32_t baud_rate)
 {
     hi_uart_attribute uart_attr =
     {
-        .baud_rate = 9600,
+        .baud_rate = baud_rate,
         .data_bits = HI_UART_DATA_BIT_8,
         .stop_bits = HI_UART_STOP_BIT_1,
         .parity = HI_UART_PARITY_NONE,
@@ -53,7 +62,7 @@ void Uart1Config(void)
         .tx_block = HI_UART_BLOCK_STATE_BLOCK,
         .rx_block = HI_UART_BLOCK_STATE_BLOCK,
         .tx_buf_size = 256,
-        .rx_buf_size = 256,
+        .rx_buf_size = 1024,
         .tx_use_dma = HI_UART_NONE_DMA,
         .rx_use_dma = HI_UART_NONE_DMA,
     };
@@ -63,119 +72,165 @@ void Uart1Config(void)
 
 }
 
+static nmea_parser_t g_nmea_parser;
+static gps_filter_t g_gps_filter;
+
+/*
+ * 最新定位快照，按顺序锁（seqlock）发布：写者在修改前后各把 g_snapshot_seq 加一，
+ * 读者看到奇数或前后序号不一致就重读，任何任务都可无锁读取到完整一致的快照。
+ */
+static gps_snapshot_t g_snapshot;
+static volatile uint32_t g_snapshot_seq = 0;
+static volatile uint8_t g_last_quality = 0;
+
 /***********************************************************************
-* 函数名称: dm_to_dd
-* 说    明: 将 GPS 输出的度分格式 (ddmm.mmmm) 转换为度格式 (dd.dddd)
-* 参    数: dm：度分格式的浮点数值
-* 返 回 值: 转换后的度值（小数形式）
+* 函数名称: gps_publish_snapshot
+* 说    明: 发布快照：有新的有效定位时一并更新，滤波轨迹每次都外推到当前时刻
+* 参    数: fix：综合定位记录，为 NULL 时只更新滤波轨迹
+* 返 回 值: 无
 ************************************************************************/
-double dm_to_dd(double dm) 
+static void gps_publish_snapshot(const nmea_fix_t *fix)
 {
-    double degree = (int)(dm / 100);
-    double minute = dm - degree * 100;
-    return degree + minute / 60;
+    uint32_t now_ms = hi_get_milli_seconds();
+
+    g_snapshot_seq++;
+    __sync_synchronize();
+    if (fix != NULL) {
+        g_snapshot.fix = *fix;
+        g_snapshot.fix_ms = now_ms;
+        g_snapshot.valid = 1;
+    }
+    gps_filter_output(&g_gps_filter, now_ms, &g_snapshot.track);
+    __sync_synchronize();
+    g_snapshot_seq++;
 }
 
 /***********************************************************************
-* 函数名称: hi_uart_read_timeout23
-* 说    明: 带超时机制的 UART 读取函数，超过 timeout_ms 仍无数据则返回 0
-* 参    数: uart_idx：串口编号
-*           buf：读取数据的缓存区
-*           buf_size：缓存区大小
-*           timeout_ms：最大等待时间（毫秒）
-* 返 回 值: 实际读取到的数据长度，0 表示超时未读取到数据
+* 函数名称: gps_on_fix
+* 说    明: NMEA 解析器回调，以每个定位周期的 GGA 为准，
+*           只发布定位质量为 1/2、非“未定位”模式且 HDOP 合格的结果，
+*           并送入卡尔曼滤波器（跳点由滤波器门限剔除，原始定位照常发布），
+*           被接受的滤波位置记入轨迹缓存；有效的 RMC 用于校准 UTC 时钟
+* 参    数: fix：综合定位记录
+*           type：本次更新的语句类型
+*           arg：未使用
+* 返 回 值: 无
 ************************************************************************/
-int hi_uart_read_timeout23(int uart_idx, unsigned char *buf, int buf_size, int timeout_ms) {
-    struct timeval start, now;
-    gettimeofday(&start, NULL);
-
-    int len = 0;
-    while (1) 
-    {
-        len = hi_uart_read(uart_idx, buf, buf_size);
-        if (len > 0) 
-        {
-            return len;
-        }
+static void gps_on_fix(const nmea_fix_t *fix, nmea_sentence_t type, void *arg)
+{
+    (void)arg;
+    if (type == NMEA_SENTENCE_RMC && fix->rmc_valid && fix->utc_date != 0) {
+        time_service_sync_gps(fix->utc_date, fix->utc_time, hi_get_milli_seconds());
+        return;
+    }
+    if (type != NMEA_SENTENCE_GGA) {
+        return;
+    }
+    g_last_quality = fix->quality;
+    if (fix->quality != 1 && fix->quality != 2) {
+        return;
+    }
+    if (fix->fix_mode == 1 || (fix->hdop > 0.0f && fix->hdop > GPS_MAX_HDOP)) {
+        return;
+    }
+    uint32_t now_ms = hi_get_milli_seconds();
+    if (gps_filter_update(&g_gps_filter, fix, now_ms) == 0) {
+        gps_track_t track;
+        gps_filter_output(&g_gps_filter, now_ms, &track);
+        gps_track_add(track.lat_e7, track.lon_e7, now_ms, fix->utc_date, fix->utc_time);
+    }
+    gps_publish_snapshot(fix);
+}
 
-        usleep(100);
+/***********************************************************************
+* 函数名称: gps_get_snapshot
+* 说    明: 读取最新定位快照，可在任意任务中调用，不会阻塞在串口上
+* 参    数: out：输出快照，age_ms 与 quality 在读取时填写
+* 返 回 值: 1 表示曾获得过有效定位，0 表示尚未定位
+************************************************************************/
+int gps_get_snapshot(gps_snapshot_t *out)
+{
+    uint32_t seq;
 
-        gettimeofday(&now, NULL);
-        double elapsed = (now.tv_sec - start.tv_sec) * 1000.0 +  (now.tv_usec - start.tv_usec) / 1000.0;
-        if (elapsed >= timeout_ms) 
-        {
-            printf("超时\n");
-            return 0;
+    while (1) {
+        seq = g_snapshot_seq;
+        if (seq & 1) {
+            osDelay(1);     // 写者在发布过程中被抢占，让出 CPU 等它完成
+            continue;
+        }
+        __sync_synchronize();
+        *out = g_snapshot;
+        __sync_synchronize();
+        if (seq == g_snapshot_seq) {
+            break;
         }
     }
+    out->quality = g_last_quality;
+    out->age_ms = out->valid ? hi_get_milli_seconds() - out->fix_ms : 0;
+    return out->valid;
 }
 
 /***********************************************************************
-* 函数名称: UartTask
-* 说    明: 串口任务初始化函数，配置 UART 引脚与参数
+* 函数名称: gps_print_stats
+* 说    明: 打印串口接收与 NMEA 解析统计。SDK 不报告硬件 FIFO 与驱动接收缓冲的溢出，
+*           这类丢字节只能从校验错误与超长语句数看出（切换波特率时也会有少量）
 * 参    数: 无
 * 返 回 值: 无
 ************************************************************************/
-static void UartTask(void)
+void gps_print_stats(void)
 {
-    printf("UartTask Initing\n");
-    Uart1GpioInit();
-    Uart1Config();
-    printf("UartTask Init Ended\n");
+    gps_uart_print_stats();
+    printf("[gps] sentences=%u checksum_errors=%u overflows=%u\n", (unsigned)g_nmea_parser.sentences,
+           (unsigned)g_nmea_parser.checksum_errors, (unsigned)g_nmea_parser.overflows);
 }
 
 /***********************************************************************
-* 函数名称: RunGPS
-* 说    明: 解析 UART 中读取的 $GNGGA NMEA 语句，提取并计算经纬度
-* 参    数: lat：指向纬度变量的指针
-*           lon：指向经度变量的指针
-* 返 回 值: 无（经纬度通过指针返回）
+* 函数名称: GpsTask
+* 说    明: GPS 任务：配置 UART 引脚与参数、启动中断接收并配置接收机，
+*           注入上次保存的定位作为辅助数据，
+*           随后持续把接收环形缓冲中的数据喂给 NMEA 解析器并发布快照，
+*           每轮根据最新快照调度接收机的连续 / 周期 / 待机模式
+* 参    数: 无
+* 返 回 值: 无
 ************************************************************************/
-void RunGPS(double *lat, double *lon){
-    int len = 0;
-    unsigned char uartReadBuff[UART_BUFF_SIZE] = {0};
-    int located = 0;
-        usleep(U_SLEEP_TIME);
-        len = hi_uart_read_timeout23(HI_UART_IDX_1, uartReadBuff, UART_BUFF_SIZE, 2000);
-        if (len > 0) 
-        {
-            uartReadBuff[len] = 0;
-            char *nmea_gngga = strstr((char *)uartReadBuff, "$GNGGA");
-            if (nmea_gngga != NULL) {
-                char *token;
-                token = strtok(nmea_gngga, ",");
-                char *nmea_fields[15];
-                int i = 0;
-                while (token != NULL && i < 15) 
-                {
-                    nmea_fields[i++] = token;
-                    token = strtok(NULL, ",");
-                }
-
-                if (i > 6 && (strcmp(nmea_fields[6], "1") == 0 || strcmp(nmea_fields[6], "2") == 0)) 
-                {
-                    printf("确认定位成功\n");
-                    located = 1;
-
-                    char ddmm_output[128];
-                    sprintf(ddmm_output, "%s %s,%s %s", nmea_fields[2], nmea_fields[3], nmea_fields[4], nmea_fields[5]);
-
-                    double dd0 = dm_to_dd(atof(nmea_fields[2]));
-                    double dd1 = dm_to_dd(atof(nmea_fields[4]));
-                    *lat = dd0;
-                    *lon = dd1;
-                    printf("[$GNGGA,WGS-84]经纬度数据 : %0.5lf, %0.5lf\n", dd0, dd1);
-
-                    return; 
-                }
-            }
-        }
+static void GpsTask(void)
+{
+    uint8_t buf[UART_BUFF_SIZE];
+    int len;
+    gps_cfg_t cfg;
+    gps_snapshot_t snap;
 
+    printf("GpsTask Initing\n");
+    Uart1GpioInit();
+    Uart1Config(GPS_DEFAULT_BAUD);
+    gps_uart_start();
+    nmea_parser_init(&g_nmea_parser, gps_on_fix, NULL);
+    gps_filter_init(&g_gps_filter);
+    gps_track_init();
+    gps_config_get_default(&cfg);
+    gps_config_apply(&cfg, &g_nmea_parser, NULL);
+    gps_aiding_inject();
+    gps_power_init(hi_get_milli_seconds());
+    printf("GpsTask Init Ended\n");
+
+    while (1) {
+        if (gps_config_take_request(&cfg)) {
+            gps_config_apply(&cfg, &g_nmea_parser, NULL);
+        }
+        len = gps_uart_read(buf, sizeof(buf), GPS_READ_TIMEOUT_MS);
+        if (len > 0) {
+            nmea_parser_feed(&g_nmea_parser, buf, len);
+        }
+        gps_publish_snapshot(NULL);
+        gps_get_snapshot(&snap);
+        gps_aiding_poll(&snap, hi_get_milli_seconds());
+        gps_power_poll(&snap, hi_get_milli_seconds());
+    }
 }
 
 /***********************************************************************
 * 函数名称: UartExampleEntry
-* 说    明: UART 示例入口函数，禁用看门狗并创建 UART 任务线程
+* 说    明: GPS 入口函数，禁用看门狗并创建 GPS 任务线程
 * 参    数: 无
 * 返 回 值: 无
 ************************************************************************/
@@ -184,16 +239,16 @@ void UartExampleEntry(void)
     osThreadAttr_t attr;
     hi_watchdog_disable();
 
-    attr.name = "UartTask";
+    attr.name = "GpsTask";
     attr.attr_bits = 0U;
     attr.cb_mem = NULL;
     attr.cb_size = 0U;
     attr.stack_mem = NULL;
-    attr.stack_size = 25 * 1024;
-    attr.priority = osPriorityNormal;
+    attr.stack_size = GPS_TASK_STACK_SIZE;
+    attr.priority = GPS_TASK_PRIO;
 
-    if (osThreadNew((osThreadFunc_t)UartTask, NULL, &attr) == NULL) 
+    if (osThreadNew((osThreadFunc_t)GpsTask, NULL, &attr) == NULL) 
     {
-        printf("[UartTask] Failed to create UartTask!\n");
+        printf("[GpsTask] Failed to create GpsTask!\n");
     }
 }
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <string.h>
+#include "hi_time.h"
+#include "gps_config.h"
+#include "nv_store.h"
+#include "time_service.h"
+#include "gps_aiding.h"
+
+static gps_ttff_t g_ttff;
+static uint32_t g_last_save_ms;
+static int g_saved = 0;
+static gps_aiding_rec_t g_rec;          // 保存的位置，时间字段为注入时的当前 UTC
+static int g_time_pending = 0;          // 启动时尚未校时，等时钟可用后再注入时间
+
+/***********************************************************************
+* 函数名称: gps_aiding_put_le
+* 说    明: 按小端序写入整数
+* 参    数: p：输出位置
+*           val：数值
+*           size：字节数
+* 返 回 值: 无
+************************************************************************/
+static void gps_aiding_put_le(uint8_t *p, uint32_t val, int size)
+{
+    for (int i = 0; i < size; i++) {
+        p[i] = (uint8_t)(val >> (8 * i));
+    }
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_send_pmtk
+* 说    明: PMTK741 注入参考位置与 UTC 时间。该命令没有精度字段，接收机把时间当作准确值，
+*           只能在时钟已校准时发送
+* 参    数: rec：参考位置与当前 UTC 时间
+* 返 回 值: 无
+************************************************************************/
+static void gps_aiding_send_pmtk(const gps_aiding_rec_t *rec)
+{
+    char body[80];
+    char lat[16];
+    char lon[16];
+
+    nmea_format_e7(rec->lat_e7, lat, sizeof(lat));
+    nmea_format_e7(rec->lon_e7, lon, sizeof(lon));
+    snprintf(body, sizeof(body), "PMTK741,%s,%s,%d,%u,%02u,%02u,%02u,%02u,%02u",
+             lat, lon, (int)(rec->alt_dm / 10),
+             2000 + (unsigned)(rec->utc_date % 100), (unsigned)(rec->utc_date / 100 % 100),
+             (unsigned)(rec->utc_date / 10000), (unsigned)(rec->utc_time / 10000),
+             (unsigned)(rec->utc_time / 100 % 100), (unsigned)(rec->utc_time % 100));
+    gps_config_send_nmea(body);
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_send_ubx_pos
+* 说    明: UBX-MGA-INI-POS_LLH 注入位置
+* 参    数: rec：保存的定位记录
+* 返 回 值: 无
+************************************************************************/
+static void gps_aiding_send_ubx_pos(const gps_aiding_rec_t *rec)
+{
+    uint8_t pos[20] = { 0 };
+
+    pos[0] = 0x01;
+    gps_aiding_put_le(&pos[4], (uint32_t)rec->lat_e7, 4);
+    gps_aiding_put_le(&pos[8], (uint32_t)rec->lon_e7, 4);
+    gps_aiding_put_le(&pos[12], (uint32_t)(rec->alt_dm * 10), 4);
+    gps_aiding_put_le(&pos[16], GPS_AIDING_POS_ACC_M * 100U, 4);
+    gps_config_send_ubx(0x13, 0x40, pos, sizeof(pos));
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_send_ubx_time
+* 说    明: UBX-MGA-INI-TIME_UTC 注入当前 UTC 时间
+* 参    数: rec：时间字段为当前 UTC
+* 返 回 值: 无
+************************************************************************/
+static void gps_aiding_send_ubx_time(const gps_aiding_rec_t *rec)
+{
+    uint8_t utc[24] = { 0 };
+
+    utc[0] = 0x10;
+    utc[3] = 0x80;      // 闰秒未知
+    gps_aiding_put_le(&utc[4], 2000 + rec->utc_date % 100, 2);
+    utc[6] = (uint8_t)(rec->utc_date / 100 % 100);
+    utc[7] = (uint8_t)(rec->utc_date / 10000);
+    utc[8] = (uint8_t)(rec->utc_time / 10000);
+    utc[9] = (uint8_t)(rec->utc_time / 100 % 100);
+    utc[10] = (uint8_t)(rec->utc_time % 100);
+    gps_aiding_put_le(&utc[16], GPS_AIDING_TIME_ACC_S, 2);
+    gps_config_send_ubx(0x13, 0x40, utc, sizeof(utc));
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_inject_time
+* 说    明: 时钟已校准（SNTP 等）时注入当前 UTC 时间，PMTK 命令集连同位置一起注入。
+*           断电前保存的时间可能已过去数小时，不注入
+* 参    数: now_ms：当前单调时钟
+* 返 回 值: 1 已注入，0 尚未校时
+************************************************************************/
+static int gps_aiding_inject_time(uint32_t now_ms)
+{
+    if (time_service_utc_nmea(now_ms, &g_rec.utc_date, &g_rec.utc_time) != 0) {
+        return 0;
+    }
+    if (gps_config_profile() == GPS_CFG_PROFILE_PMTK) {
+        gps_aiding_send_pmtk(&g_rec);
+    } else {
+        gps_aiding_send_ubx_time(&g_rec);
+    }
+    g_ttff.aided = 1;
+    printf("[gps_aiding] injected time %06u %06u\n", (unsigned)g_rec.utc_date, (unsigned)g_rec.utc_time);
+    return 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_inject
+* 说    明: 读取 flash 中保存的最近一次定位，作为辅助数据注入接收机以实现温启动。
+*           设备没有 RTC，时间只在时钟已校准时注入；启动时尚未校时则在
+*           首次定位前等时钟可用再注入（PMTK741 需要时间，位置也一起推迟）。
+*           需在接收机配置完成后、GPS 任务上下文中调用
+* 参    数: 无
+* 返 回 值: 1 已注入（至少位置），0 无可用记录、等待校时或接收机命令集不支持
+************************************************************************/
+int gps_aiding_inject(void)
+{
+    gps_cfg_profile_t profile = gps_config_profile();
+
+    memset(&g_ttff, 0, sizeof(g_ttff));
+    g_time_pending = 0;
+    if (profile != GPS_CFG_PROFILE_PMTK && profile != GPS_CFG_PROFILE_UBX) {
+        return 0;
+    }
+    if (nv_store_read(NV_KEY_GPS_AIDING, &g_rec, sizeof(g_rec)) != (int)sizeof(g_rec) || g_rec.utc_date == 0) {
+        printf("[gps_aiding] no saved fix, cold start\n");
+        return 0;
+    }
+    if (profile == GPS_CFG_PROFILE_UBX) {
+        gps_aiding_send_ubx_pos(&g_rec);
+        g_ttff.aided = 1;
+        printf("[gps_aiding] injected lat %ld lon %ld\n", (long)g_rec.lat_e7, (long)g_rec.lon_e7);
+    }
+    if (!gps_aiding_inject_time(hi_get_milli_seconds())) {
+        g_time_pending = 1;
+        printf("[gps_aiding] clock not set, time injection deferred\n");
+    }
+    return g_ttff.aided;
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_poll
+* 说    明: GPS 任务每轮循环调用：记录首次定位时间，
+*           并在首次定位及之后每隔 GPS_AIDING_SAVE_INTERVAL_MS 把定位写入 flash
+* 参    数: snap：最新定位快照
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+void gps_aiding_poll(const gps_snapshot_t *snap, uint32_t now_ms)
+{
+    gps_aiding_rec_t rec;
+
+    if (!snap->valid || snap->age_ms >= GPS_FIX_MAX_AGE_MS) {
+        if (g_time_pending && !g_ttff.fixed && gps_aiding_inject_time(now_ms)) {
+            g_time_pending = 0;
+        }
+        return;
+    }
+    g_time_pending = 0;
+    if (!g_ttff.fixed) {
+        // 接收机随系统上电，毫秒计数从启动开始，定位时刻即 TTFF
+        g_ttff.ttff_ms = snap->fix_ms;
+        g_ttff.fixed = 1;
+        printf("[gps_aiding] TTFF %u ms (%s)\n", (unsigned)g_ttff.ttff_ms, g_ttff.aided ? "aided" : "cold");
+    }
+    if (snap->fix.utc_date == 0 || (g_saved && now_ms - g_last_save_ms < GPS_AIDING_SAVE_INTERVAL_MS)) {
+        return;
+    }
+    rec.utc_date = snap->fix.utc_date;
+    rec.utc_time = snap->fix.utc_time;
+    rec.lat_e7 = snap->fix.lat_e7;
+    rec.lon_e7 = snap->fix.lon_e7;
+    rec.alt_dm = (int32_t)(snap->fix.altitude * 10.0f);
+    if (nv_store_write(NV_KEY_GPS_AIDING, &rec, sizeof(rec)) != 0) {
+        printf("[gps_aiding] failed to save fix\n");
+    }
+    g_saved = 1;
+    g_last_save_ms = now_ms;
+}
+
+/***********************************************************************
+* 函数名称: gps_aiding_get_ttff
+* 说    明: 获取本次上电的首次定位时间
+* 参    数: ttff：输出
+* 返 回 值: 无
+************************************************************************/
+void gps_aiding_get_ttff(gps_ttff_t *ttff)
+{
+    memcpy(ttff, &g_ttff, sizeof(*ttff));
+}
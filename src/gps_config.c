@@ -0,0 +1,406 @@
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "gps_uart.h"
+#include "gps_config.h"
+
+#define GPS_CFG_MATCH_MAX   16
+#define GPS_CFG_UBX_SYNC1   0xB5
+#define GPS_CFG_UBX_SYNC2   0x62
+#define GPS_CFG_BAUD_TX_MS  50      // 波特率命令约 30 字节，9600 波特率下约 31 ms 发送完毕
+
+static gps_cfg_profile_t g_profile = GPS_CFG_PROFILE_NONE;
+static gps_cfg_t g_request;
+static volatile int g_request_pending = 0;
+
+/*
+ * 需要输出的语句及其输出间隔（每几个定位周期输出一次），其余关闭。
+ * GSV 只用于统计可见卫星与载噪比，降频输出即可。
+ */
+typedef struct
+{
+    uint8_t ubx_id;     // UBX NMEA 类（0xF0）下的消息号
+    uint8_t rate;
+} gps_cfg_msg_t;
+
+static const gps_cfg_msg_t g_ubx_msgs[] =
+{
+    { 0x00, 1 },    // GGA
+    { 0x01, 0 },    // GLL
+    { 0x02, 1 },    // GSA
+    { 0x03, 5 },    // GSV
+    { 0x04, 1 },    // RMC
+    { 0x05, 1 },    // VTG
+    { 0x06, 0 },    // GRS
+    { 0x07, 0 },    // GST
+    { 0x08, 0 },    // ZDA
+};
+
+// PMTK314 字段顺序：GLL,RMC,VTG,GGA,GSA,GSV,保留...,MCHN
+#define GPS_CFG_PMTK_MASK   "PMTK314,0,1,1,1,1,5,0,0,0,0,0,0,0,0,0,0,0,0,0"
+
+/***********************************************************************
+* 函数名称: gps_config_ms_to_ticks
+* 说    明: 毫秒换算为系统节拍，向上取整且至少 1 个节拍
+* 参    数: ms：毫秒
+* 返 回 值: 节拍数
+************************************************************************/
+static uint32_t gps_config_ms_to_ticks(uint32_t ms)
+{
+    uint32_t ticks = (uint32_t)(((uint64_t)ms * osKernelGetTickFreq() + 999) / 1000);
+
+    return ticks > 0 ? ticks : 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_send_nmea
+* 说    明: 发送一条 NMEA 格式命令，自动加上 '$'、校验和与回车换行
+* 参    数: body：'$' 与 '*' 之间的内容，如 "PMTK220,1000"
+* 返 回 值: 发送的字节数，失败返回 -1
+************************************************************************/
+int gps_config_send_nmea(const char *body)
+{
+    char line[96];
+    uint8_t checksum = 0;
+
+    for (const char *c = body; *c != '\0'; c++) {
+        checksum ^= (uint8_t)*c;
+    }
+    int len = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, checksum);
+    if (len <= 0 || len >= (int)sizeof(line)) {
+        return -1;
+    }
+    return gps_uart_write((const uint8_t *)line, len);
+}
+
+/***********************************************************************
+* 函数名称: gps_config_send_ubx
+* 说    明: 发送一帧 UBX 消息，自动加上同步字、长度与 Fletcher 校验
+* 参    数: cls / id：消息类与消息号
+*           payload：负载，可为 NULL
+*           len：负载长度
+* 返 回 值: 发送的字节数，失败返回 -1
+************************************************************************/
+int gps_config_send_ubx(uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len)
+{
+    uint8_t frame[8 + 48];
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    if (len > sizeof(frame) - 8) {
+        return -1;
+    }
+    frame[0] = GPS_CFG_UBX_SYNC1;
+    frame[1] = GPS_CFG_UBX_SYNC2;
+    frame[2] = cls;
+    frame[3] = id;
+    frame[4] = (uint8_t)(len & 0xFF);
+    frame[5] = (uint8_t)(len >> 8);
+    if (len > 0) {
+        memcpy(&frame[6], payload, len);
+    }
+    for (int i = 2; i < 6 + len; i++) {
+        ck_a += frame[i];
+        ck_b += ck_a;
+    }
+    frame[6 + len] = ck_a;
+    frame[7 + len] = ck_b;
+    return gps_uart_write(frame, 8 + len);
+}
+
+/***********************************************************************
+* 函数名称: gps_config_wait_pattern
+* 说    明: 在接收流中等待指定字节序列出现，期间收到的数据照常喂给 NMEA 解析器
+* 参    数: pat / pat_len：待匹配的字节序列（不超过 GPS_CFG_MATCH_MAX）
+*           parser：NMEA 解析器，可为 NULL
+*           timeout_ms：超时时间
+* 返 回 值: 0 匹配成功，-1 超时
+************************************************************************/
+static int gps_config_wait_pattern(const uint8_t *pat, int pat_len, nmea_parser_t *parser, uint32_t timeout_ms)
+{
+    uint8_t window[GPS_CFG_MATCH_MAX];
+    uint8_t buf[64];
+    int fill = 0;
+    uint32_t start = hi_get_milli_seconds();
+
+    if (pat_len > GPS_CFG_MATCH_MAX) {
+        return -1;
+    }
+    uint32_t elapsed;
+    while ((elapsed = hi_get_milli_seconds() - start) < timeout_ms) {
+        int len = gps_uart_read(buf, sizeof(buf), timeout_ms - elapsed);
+        if (len <= 0) {
+            continue;
+        }
+        if (parser != NULL) {
+            nmea_parser_feed(parser, buf, len);
+        }
+        for (int i = 0; i < len; i++) {
+            if (fill == pat_len) {
+                memmove(window, window + 1, pat_len - 1);
+                fill--;
+            }
+            window[fill++] = buf[i];
+            if (fill == pat_len && memcmp(window, pat, pat_len) == 0) {
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_wait_pmtk_ack
+* 说    明: 等待 $PMTK001,<cmd>,3（命令执行成功）应答
+* 参    数: cmd：被应答的命令号
+*           parser：NMEA 解析器，可为 NULL
+*           timeout_ms：超时时间
+* 返 回 值: 0 成功，-1 超时或失败
+************************************************************************/
+int gps_config_wait_pmtk_ack(int cmd, nmea_parser_t *parser, uint32_t timeout_ms)
+{
+    char pat[GPS_CFG_MATCH_MAX + 1];
+    int len = snprintf(pat, sizeof(pat), "$PMTK001,%d,3", cmd);
+
+    return gps_config_wait_pattern((const uint8_t *)pat, len, parser, timeout_ms);
+}
+
+/***********************************************************************
+* 函数名称: gps_config_wait_ubx_ack
+* 说    明: 等待 UBX-ACK-ACK 应答
+* 参    数: cls / id：被应答的消息类与消息号
+*           parser：NMEA 解析器，可为 NULL
+*           timeout_ms：超时时间
+* 返 回 值: 0 成功，-1 超时
+************************************************************************/
+int gps_config_wait_ubx_ack(uint8_t cls, uint8_t id, nmea_parser_t *parser, uint32_t timeout_ms)
+{
+    const uint8_t pat[] = { GPS_CFG_UBX_SYNC1, GPS_CFG_UBX_SYNC2, 0x05, 0x01, 0x02, 0x00, cls, id };
+
+    return gps_config_wait_pattern(pat, sizeof(pat), parser, timeout_ms);
+}
+
+/***********************************************************************
+* 函数名称: gps_config_wait_traffic
+* 说    明: 等待解析器收到至少两条校验通过的语句，用于确认当前波特率可用
+* 参    数: parser：NMEA 解析器
+*           timeout_ms：超时时间
+* 返 回 值: 0 链路正常，-1 超时
+************************************************************************/
+static int gps_config_wait_traffic(nmea_parser_t *parser, uint32_t timeout_ms)
+{
+    uint8_t buf[64];
+    uint32_t base = parser->sentences;
+    uint32_t start = hi_get_milli_seconds();
+
+    while (hi_get_milli_seconds() - start < timeout_ms) {
+        int len = gps_uart_read(buf, sizeof(buf), 100);
+        if (len > 0) {
+            nmea_parser_feed(parser, buf, len);
+        }
+        if (parser->sentences - base >= 2) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_set_mask
+* 说    明: 只保留解析器会用到的语句（GGA/RMC/VTG/GSA，GSV 降频）
+* 参    数: profile：命令集
+*           parser：NMEA 解析器
+* 返 回 值: 0 全部应答成功，-1 失败
+************************************************************************/
+static int gps_config_set_mask(gps_cfg_profile_t profile, nmea_parser_t *parser)
+{
+    if (profile == GPS_CFG_PROFILE_PMTK) {
+        gps_config_send_nmea(GPS_CFG_PMTK_MASK);
+        return gps_config_wait_pmtk_ack(314, parser, GPS_CFG_ACK_TIMEOUT_MS);
+    }
+
+    int ret = 0;
+    for (unsigned int i = 0; i < sizeof(g_ubx_msgs) / sizeof(g_ubx_msgs[0]); i++) {
+        uint8_t payload[3] = { 0xF0, g_ubx_msgs[i].ubx_id, g_ubx_msgs[i].rate };
+        gps_config_send_ubx(0x06, 0x01, payload, sizeof(payload));     // CFG-MSG
+        if (gps_config_wait_ubx_ack(0x06, 0x01, parser, GPS_CFG_ACK_TIMEOUT_MS) != 0) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_send_baud
+* 说    明: 通知接收机切换波特率（两种协议在切换后都不保证能收到应答）
+* 参    数: profile：命令集
+*           baud_rate：新的波特率
+* 返 回 值: 无
+************************************************************************/
+static void gps_config_send_baud(gps_cfg_profile_t profile, uint32_t baud_rate)
+{
+    if (profile == GPS_CFG_PROFILE_PMTK) {
+        char body[24];
+        snprintf(body, sizeof(body), "PMTK251,%u", (unsigned int)baud_rate);
+        gps_config_send_nmea(body);
+        return;
+    }
+
+    // CFG-PRT：UART1，8N1，输入 UBX+NMEA，输出 UBX+NMEA
+    uint8_t payload[20] = { 0 };
+    payload[0] = 0x01;
+    payload[4] = 0xD0;
+    payload[5] = 0x08;
+    payload[8] = (uint8_t)(baud_rate & 0xFF);
+    payload[9] = (uint8_t)((baud_rate >> 8) & 0xFF);
+    payload[10] = (uint8_t)((baud_rate >> 16) & 0xFF);
+    payload[11] = (uint8_t)((baud_rate >> 24) & 0xFF);
+    payload[12] = 0x03;
+    payload[14] = 0x03;
+    gps_config_send_ubx(0x06, 0x00, payload, sizeof(payload));
+}
+
+/***********************************************************************
+* 函数名称: gps_config_set_rate
+* 说    明: 设置定位输出间隔
+* 参    数: profile：命令集
+*           rate_ms：输出间隔（毫秒）
+*           parser：NMEA 解析器
+* 返 回 值: 0 应答成功，-1 失败
+************************************************************************/
+static int gps_config_set_rate(gps_cfg_profile_t profile, uint16_t rate_ms, nmea_parser_t *parser)
+{
+    if (profile == GPS_CFG_PROFILE_PMTK) {
+        char body[24];
+        snprintf(body, sizeof(body), "PMTK220,%u", (unsigned int)rate_ms);
+        gps_config_send_nmea(body);
+        return gps_config_wait_pmtk_ack(220, parser, GPS_CFG_ACK_TIMEOUT_MS);
+    }
+
+    // CFG-RATE：measRate、navRate=1、timeRef=GPS
+    uint8_t payload[6] = { (uint8_t)(rate_ms & 0xFF), (uint8_t)(rate_ms >> 8), 0x01, 0x00, 0x01, 0x00 };
+    gps_config_send_ubx(0x06, 0x08, payload, sizeof(payload));
+    return gps_config_wait_ubx_ack(0x06, 0x08, parser, GPS_CFG_ACK_TIMEOUT_MS);
+}
+
+/***********************************************************************
+* 函数名称: gps_config_get_default
+* 说    明: 获取编译期默认配置
+* 参    数: cfg：输出
+* 返 回 值: 无
+************************************************************************/
+void gps_config_get_default(gps_cfg_t *cfg)
+{
+    cfg->profile = GPS_CFG_PROFILE;
+    cfg->baud_rate = GPS_CFG_BAUD;
+    cfg->rate_ms = GPS_CFG_RATE_MS;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_apply
+* 说    明: 配置接收机：先确认链路波特率，再屏蔽不用的语句，
+*           随后切换到目标波特率并用收到的合法语句验证（失败则退回原波特率），
+*           最后设置定位输出频率。需在 GPS 任务上下文中调用
+* 参    数: cfg：目标配置
+*           parser：NMEA 解析器，配置期间收到的语句照常解析
+*           result：配置结果，可为 NULL
+* 返 回 值: 0 全部成功，-1 有步骤失败（已尽量保持链路可用）
+************************************************************************/
+int gps_config_apply(const gps_cfg_t *cfg, nmea_parser_t *parser, gps_cfg_result_t *result)
+{
+    gps_cfg_result_t res = { 0 };
+    uint32_t old_baud = gps_uart_get_baud();
+    uint16_t rate_ms = cfg->rate_ms;
+
+    res.link_baud = old_baud;
+    if (cfg->profile == GPS_CFG_PROFILE_NONE) {
+        g_profile = GPS_CFG_PROFILE_NONE;
+        if (result != NULL) {
+            *result = res;
+        }
+        return 0;
+    }
+
+    // 模块带备份电源时可能仍保持上次配置的波特率
+    if (gps_config_wait_traffic(parser, GPS_CFG_VERIFY_TIMEOUT_MS) != 0 && cfg->baud_rate != old_baud) {
+        gps_uart_set_baud(cfg->baud_rate);
+        if (gps_config_wait_traffic(parser, GPS_CFG_VERIFY_TIMEOUT_MS) == 0) {
+            old_baud = cfg->baud_rate;
+        } else {
+            gps_uart_set_baud(old_baud);
+        }
+    }
+    g_profile = cfg->profile;
+
+    res.mask_ok = (gps_config_set_mask(cfg->profile, parser) == 0);
+
+    if (cfg->baud_rate != old_baud) {
+        gps_config_send_baud(cfg->profile, cfg->baud_rate);
+        osDelay(gps_config_ms_to_ticks(GPS_CFG_BAUD_TX_MS));    // 等待命令在旧波特率下发送完毕
+        gps_uart_set_baud(cfg->baud_rate);
+        if (gps_config_wait_traffic(parser, GPS_CFG_VERIFY_TIMEOUT_MS) == 0) {
+            res.baud_ok = 1;
+        } else {
+            gps_uart_set_baud(old_baud);
+        }
+    } else {
+        res.baud_ok = 1;
+    }
+    res.link_baud = gps_uart_get_baud();
+
+    if (rate_ms < 1000 && res.link_baud < GPS_CFG_MIN_FAST_BAUD) {
+        rate_ms = 1000;
+    }
+    res.rate_ok = (gps_config_set_rate(cfg->profile, rate_ms, parser) == 0);
+    res.rate_ms = rate_ms;
+
+    printf("[gps_config] profile %d: mask %s, baud %u %s, rate %ums %s\n", cfg->profile,
+           res.mask_ok ? "ok" : "fail", (unsigned int)res.link_baud, res.baud_ok ? "ok" : "fail",
+           (unsigned int)rate_ms, res.rate_ok ? "ok" : "fail");
+    if (result != NULL) {
+        *result = res;
+    }
+    return (res.mask_ok && res.baud_ok && res.rate_ok) ? 0 : -1;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_request
+* 说    明: 运行时请求重新配置接收机，由 GPS 任务在下一轮循环中执行
+* 参    数: cfg：目标配置
+* 返 回 值: 无
+************************************************************************/
+void gps_config_request(const gps_cfg_t *cfg)
+{
+    g_request = *cfg;
+    __sync_synchronize();
+    g_request_pending = 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_take_request
+* 说    明: 取出待执行的配置请求
+* 参    数: cfg：输出
+* 返 回 值: 1 有请求，0 无请求
+************************************************************************/
+int gps_config_take_request(gps_cfg_t *cfg)
+{
+    if (!g_request_pending) {
+        return 0;
+    }
+    g_request_pending = 0;
+    __sync_synchronize();
+    *cfg = g_request;
+    return 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_config_profile
+* 说    明: 获取当前生效的命令集
+* 参    数: 无
+* 返 回 值: 命令集
+************************************************************************/
+gps_cfg_profile_t gps_config_profile(void)
+{
+    return g_profile;
+}
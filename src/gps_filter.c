@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "gps_filter.h"
+
+#define GPS_FILTER_M_PER_E7_LAT     0.011132f   // 纬度 1e-7 度对应的米数
+#define GPS_FILTER_INIT_VEL_VAR     25.0f       // 初始化时速度方差（(5 m/s)²），速度未知
+#define GPS_FILTER_RECENTER_M       5000.0f     // 离开原点超过该距离时平移原点，保持 float 精度
+#define GPS_FILTER_DEG_PER_RAD      57.29578f
+
+/***********************************************************************
+* 函数名称: gps_filter_meas_var
+* 说    明: 按 HDOP 与卫星数估计单轴测量方差
+* 参    数: fix：定位记录
+* 返 回 值: 方差（m²）
+************************************************************************/
+static float gps_filter_meas_var(const nmea_fix_t *fix)
+{
+    float hdop = (fix->hdop > GPS_FILTER_MIN_HDOP) ? fix->hdop : GPS_FILTER_MIN_HDOP;
+    float sigma = GPS_FILTER_UERE_M * hdop;
+    float r = sigma * sigma;
+
+    if (fix->satellites > 0 && fix->satellites < GPS_FILTER_GOOD_SATS) {
+        r *= (float)GPS_FILTER_GOOD_SATS / fix->satellites;
+    }
+    return r;
+}
+
+/***********************************************************************
+* 函数名称: gps_filter_set_origin
+* 说    明: 设置局部坐标原点
+* 参    数: f：滤波器状态
+*           lat_e7 / lon_e7：原点（1e-7 度）
+* 返 回 值: 无
+************************************************************************/
+static void gps_filter_set_origin(gps_filter_t *f, int32_t lat_e7, int32_t lon_e7)
+{
+    f->lat0_e7 = lat_e7;
+    f->lon0_e7 = lon_e7;
+    f->m_per_e7_lon = GPS_FILTER_M_PER_E7_LAT * cosf((float)lat_e7 * (float)(M_PI / 180.0 / 1e7));
+}
+
+/***********************************************************************
+* 函数名称: gps_filter_reset
+* 说    明: 以一次测量重新初始化：位置取测量值，速度为 0 且方差较大
+* 参    数: f：滤波器状态
+*           fix：定位记录
+*           r：测量方差
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+static void gps_filter_reset(gps_filter_t *f, const nmea_fix_t *fix, float r, uint32_t now_ms)
+{
+    gps_filter_set_origin(f, fix->lat_e7, fix->lon_e7);
+    f->e = 0.0f;
+    f->n = 0.0f;
+    f->ve = 0.0f;
+    f->vn = 0.0f;
+    f->p00 = r;
+    f->p01 = 0.0f;
+    f->p11 = GPS_FILTER_INIT_VEL_VAR;
+    f->last_ms = now_ms;
+    f->rejects = 0;
+    f->initialized = 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_filter_init
+* 说    明: 复位滤波器，等待下一个定位重新初始化
+* 参    数: f：滤波器状态
+* 返 回 值: 无
+************************************************************************/
+void gps_filter_init(gps_filter_t *f)
+{
+    memset(f, 0, sizeof(*f));
+}
+
+/***********************************************************************
+* 函数名称: gps_filter_update
+* 说    明: 用一次定位更新滤波器。先按匀速模型预测到测量时刻，
+*           新息超出卡方门限或隐含速度不合理的测量（多径跳点）被拒绝；
+*           连续多次被拒绝或中断超过外推时长时，以当前测量重新初始化
+* 参    数: f：滤波器状态
+*           fix：定位记录
+*           now_ms：测量时间戳（毫秒）
+* 返 回 值: 0 表示测量已被接受，-1 表示被门限拒绝
+************************************************************************/
+int gps_filter_update(gps_filter_t *f, const nmea_fix_t *fix, uint32_t now_ms)
+{
+    float r = gps_filter_meas_var(fix);
+    uint32_t dt_ms = now_ms - f->last_ms;
+
+    if (!f->initialized || dt_ms > GPS_FILTER_COAST_MS) {
+        gps_filter_reset(f, fix, r, now_ms);
+        f->accepted++;
+        return 0;
+    }
+
+    float dt = dt_ms / 1000.0f;
+    float q = GPS_FILTER_ACCEL_SIGMA * GPS_FILTER_ACCEL_SIGMA;
+    float ze = (float)((int64_t)fix->lon_e7 - f->lon0_e7) * f->m_per_e7_lon;
+    float zn = (float)((int64_t)fix->lat_e7 - f->lat0_e7) * GPS_FILTER_M_PER_E7_LAT;
+
+    // 预测
+    float ep = f->e + f->ve * dt;
+    float np = f->n + f->vn * dt;
+    float pp00 = f->p00 + 2.0f * dt * f->p01 + dt * dt * f->p11 + q * dt * dt * dt / 3.0f;
+    float pp01 = f->p01 + dt * f->p11 + q * dt * dt / 2.0f;
+    float pp11 = f->p11 + q * dt;
+
+    // 门限：马氏距离与相对上次接受位置的隐含速度
+    float ye = ze - ep;
+    float yn = zn - np;
+    float s = pp00 + r;
+    float d2 = (ye * ye + yn * yn) / s;
+    float jump_e = ze - f->e;
+    float jump_n = zn - f->n;
+    float max_jump = GPS_FILTER_MAX_SPEED_MS * dt + 3.0f * sqrtf(r);
+    if (d2 > GPS_FILTER_GATE_CHI2 || jump_e * jump_e + jump_n * jump_n > max_jump * max_jump) {
+        f->rejected++;
+        if (++f->rejects >= GPS_FILTER_MAX_REJECTS) {
+            printf("[gps_filter] %u fixes rejected in a row, reinit\n", (unsigned)f->rejects);
+            gps_filter_reset(f, fix, r, now_ms);
+            f->accepted++;
+            return 0;
+        }
+        return -1;
+    }
+
+    // 更新，两轴共用增益
+    float k0 = pp00 / s;
+    float k1 = pp01 / s;
+    f->e = ep + k0 * ye;
+    f->n = np + k0 * yn;
+    f->ve += k1 * ye;
+    f->vn += k1 * yn;
+    f->p00 = (1.0f - k0) * pp00;
+    f->p01 = (1.0f - k0) * pp01;
+    f->p11 = pp11 - k1 * pp01;
+    f->last_ms = now_ms;
+    f->rejects = 0;
+    f->accepted++;
+
+    if (fabsf(f->e) > GPS_FILTER_RECENTER_M || fabsf(f->n) > GPS_FILTER_RECENTER_M) {
+        gps_filter_set_origin(f, f->lat0_e7 + (int32_t)lroundf(f->n / GPS_FILTER_M_PER_E7_LAT),
+                              f->lon0_e7 + (int32_t)lroundf(f->e / f->m_per_e7_lon));
+        f->e = 0.0f;
+        f->n = 0.0f;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: gps_filter_output
+* 说    明: 把滤波状态按匀速外推到当前时刻并换算成经纬度、速度与航向；
+*           定位中断期间据此航位推算，超过 GPS_FILTER_COAST_MS 后输出无效
+* 参    数: f：滤波器状态
+*           now_ms：当前时间戳
+*           out：输出
+* 返 回 值: 无
+************************************************************************/
+void gps_filter_output(const gps_filter_t *f, uint32_t now_ms, gps_track_t *out)
+{
+    uint32_t age_ms = now_ms - f->last_ms;
+
+    memset(out, 0, sizeof(*out));
+    if (!f->initialized || age_ms > GPS_FILTER_COAST_MS) {
+        out->state = GPS_TRACK_NONE;
+        return;
+    }
+
+    float dt = age_ms / 1000.0f;
+    float q = GPS_FILTER_ACCEL_SIGMA * GPS_FILTER_ACCEL_SIGMA;
+    float e = f->e + f->ve * dt;
+    float n = f->n + f->vn * dt;
+    float var = f->p00 + 2.0f * dt * f->p01 + dt * dt * f->p11 + q * dt * dt * dt / 3.0f;
+
+    out->lat_e7 = f->lat0_e7 + (int32_t)lroundf(n / GPS_FILTER_M_PER_E7_LAT);
+    out->lon_e7 = f->lon0_e7 + (int32_t)lroundf(e / f->m_per_e7_lon);
+    out->speed_ms = sqrtf(f->ve * f->ve + f->vn * f->vn);
+    out->heading = atan2f(f->ve, f->vn) * GPS_FILTER_DEG_PER_RAD;
+    if (out->heading < 0.0f) {
+        out->heading += 360.0f;
+    }
+    out->pos_std_m = sqrtf(var);
+    out->state = (age_ms > GPS_FILTER_TRACK_MS) ? GPS_TRACK_COASTING : GPS_TRACK_TRACKING;
+}
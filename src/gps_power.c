@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "cmsis_os2.h"
+#include "gps_uart.h"
+#include "gps_config.h"
+#include "gps_power.h"
+#include "power_mgr.h"
+
+static gps_power_stats_t g_stats;
+static uint32_t g_last_ms;
+static uint32_t g_mode_since_ms;
+static uint32_t g_still_since_ms;
+static int g_refreshing = 0;            // 待机中定时唤醒，等待一次新定位确认是否仍静止
+static int32_t g_anchor_lat;
+static int32_t g_anchor_lon;
+static int g_anchored = 0;
+static volatile int g_activity = 0;
+
+/***********************************************************************
+* 函数名称: gps_power_distance_m
+* 说    明: 小范围内两点间距离的等距矩形近似，1e-7 度约合 0.011132 米
+* 参    数: lat1 / lon1 / lat2 / lon2：两点经纬度（1e-7 度）
+* 返 回 值: 距离（米）
+************************************************************************/
+static float gps_power_distance_m(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2)
+{
+    float dy = (float)((int64_t)lat2 - lat1) * 0.011132f;
+    float dx = (float)((int64_t)lon2 - lon1) * 0.011132f * cosf((float)lat1 * (float)(M_PI / 180.0 / 1e7));
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/***********************************************************************
+* 函数名称: gps_power_send
+* 说    明: 按当前命令集向接收机发送模式切换命令
+* 参    数: mode：目标模式
+* 返 回 值: 无
+************************************************************************/
+static void gps_power_send(gps_power_mode_t mode)
+{
+    gps_cfg_profile_t profile = gps_config_profile();
+
+    if (profile == GPS_CFG_PROFILE_PMTK) {
+        switch (mode) {
+            case GPS_PWR_STANDBY:
+                gps_config_send_nmea("PMTK161,0");
+                break;
+            case GPS_PWR_PERIODIC:
+                // 周期模式：运行 3s、睡眠 12s；未定位时运行 18s、睡眠 72s
+                gps_config_send_nmea("PMTK225,2,3000,12000,18000,72000");
+                break;
+            default:
+                // 任意命令都会唤醒待机中的接收机，PMTK225,0 同时退出周期模式
+                gps_config_send_nmea("PMTK225,0");
+                break;
+        }
+    } else if (profile == GPS_CFG_PROFILE_UBX) {
+        if (mode == GPS_PWR_STANDBY) {
+            // RXM-PMREQ：无限期进入备份模式，由串口数据唤醒
+            uint8_t payload[8] = { 0, 0, 0, 0, 0x02, 0, 0, 0 };
+            gps_config_send_ubx(0x02, 0x41, payload, sizeof(payload));
+            return;
+        }
+        if (g_stats.mode == GPS_PWR_STANDBY) {
+            const uint8_t wake[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+            gps_uart_write(wake, sizeof(wake));
+            osDelay(100);
+        }
+        // CFG-RXM：lpMode 0 连续，1 省电
+        uint8_t payload[2] = { 0x08, (mode == GPS_PWR_PERIODIC) ? 0x01 : 0x00 };
+        gps_config_send_ubx(0x06, 0x11, payload, sizeof(payload));
+    }
+}
+
+/***********************************************************************
+* 函数名称: gps_power_enter
+* 说    明: 切换工作模式并记录
+* 参    数: mode：目标模式
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+static void gps_power_enter(gps_power_mode_t mode, uint32_t now_ms)
+{
+    if (mode == g_stats.mode) {
+        return;
+    }
+    gps_power_send(mode);
+    // 待机时接收机不输出，允许芯片深睡眠；周期模式运行阶段仍有 NMEA 输出
+    power_mgr_veto(POWER_VETO_GPS_UART, mode != GPS_PWR_STANDBY);
+    printf("[gps_power] mode %d -> %d\n", g_stats.mode, mode);
+    g_stats.mode = mode;
+    g_stats.transitions++;
+    g_mode_since_ms = now_ms;
+    g_refreshing = 0;
+}
+
+/***********************************************************************
+* 函数名称: gps_power_init
+* 说    明: 初始化功耗管理，接收机默认处于连续定位模式
+* 参    数: now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+void gps_power_init(uint32_t now_ms)
+{
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.mode = GPS_PWR_ACTIVE;
+    power_mgr_veto(POWER_VETO_GPS_UART, 1);
+    g_last_ms = now_ms;
+    g_mode_since_ms = now_ms;
+    g_still_since_ms = now_ms;
+    g_refreshing = 0;
+    g_anchored = 0;
+}
+
+/***********************************************************************
+* 函数名称: gps_power_notify_activity
+* 说    明: 生命体征表明佩戴者正在活动时调用（任意任务），下一次轮询立即唤醒接收机
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void gps_power_notify_activity(void)
+{
+    g_activity = 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_power_poll
+* 说    明: GPS 任务每轮循环调用：根据速度与位置是否稳定、活动通知和定时唤醒
+*           在连续 / 周期 / 待机三种模式间切换，并累计各模式驻留时间
+* 参    数: snap：最新定位快照
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+void gps_power_poll(const gps_snapshot_t *snap, uint32_t now_ms)
+{
+    int activity = g_activity;
+    int fresh = snap->valid && snap->age_ms < GPS_FIX_MAX_AGE_MS;
+    int moving = 0;
+
+    g_activity = 0;
+    g_stats.residency_ms[g_stats.mode] += now_ms - g_last_ms;
+    g_last_ms = now_ms;
+
+    if (gps_config_profile() == GPS_CFG_PROFILE_NONE) {
+        return;
+    }
+
+    if (fresh) {
+        float dist = g_anchored ? gps_power_distance_m(g_anchor_lat, g_anchor_lon, snap->fix.lat_e7, snap->fix.lon_e7) : 0.0f;
+        float still_speed = (g_stats.mode == GPS_PWR_ACTIVE) ? GPS_PWR_STILL_SPEED_KMH : GPS_PWR_MOVE_SPEED_KMH;
+        moving = !g_anchored || snap->fix.speed_kmh >= still_speed || dist >= GPS_PWR_STILL_RADIUS_M;
+    }
+    if (activity || moving) {
+        if (fresh) {
+            g_anchor_lat = snap->fix.lat_e7;
+            g_anchor_lon = snap->fix.lon_e7;
+            g_anchored = 1;
+        }
+        g_still_since_ms = now_ms;
+    }
+
+    switch (g_stats.mode) {
+        case GPS_PWR_ACTIVE:
+            if (g_refreshing) {
+                // 定时刷新：待机前的快照已过期，等到新定位再判断，期间不重置静止计时。
+                // 有新定位且在 GPS_PWR_REFRESH_MS 内仍静止，或长时间无法定位时回到待机
+                if (activity || moving) {
+                    g_refreshing = 0;
+                } else if (now_ms - g_mode_since_ms >= (fresh ? GPS_PWR_REFRESH_MS : GPS_PWR_REFRESH_MAX_MS)) {
+                    gps_power_enter(GPS_PWR_STANDBY, now_ms);
+                }
+                break;
+            }
+            if (!fresh) {
+                g_still_since_ms = now_ms;     // 没有有效定位时不休眠，先把位置找回来
+            } else if (now_ms - g_still_since_ms >= GPS_PWR_STANDBY_AFTER_MS) {
+                gps_power_enter(GPS_PWR_STANDBY, now_ms);
+            } else if (now_ms - g_still_since_ms >= GPS_PWR_PERIODIC_AFTER_MS) {
+                gps_power_enter(GPS_PWR_PERIODIC, now_ms);
+            }
+            break;
+        case GPS_PWR_PERIODIC:
+            if (activity || moving) {
+                gps_power_enter(GPS_PWR_ACTIVE, now_ms);
+            } else if (now_ms - g_still_since_ms >= GPS_PWR_STANDBY_AFTER_MS) {
+                gps_power_enter(GPS_PWR_STANDBY, now_ms);
+            }
+            break;
+        case GPS_PWR_STANDBY:
+            if (activity) {
+                gps_power_enter(GPS_PWR_ACTIVE, now_ms);
+            } else if (now_ms - g_mode_since_ms >= GPS_PWR_WAKE_INTERVAL_MS) {
+                gps_power_enter(GPS_PWR_ACTIVE, now_ms);
+                g_refreshing = 1;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/***********************************************************************
+* 函数名称: gps_power_get_stats
+* 说    明: 获取当前模式、各模式累计驻留时间与切换次数
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void gps_power_get_stats(gps_power_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
+
+/***********************************************************************
+* 函数名称: gps_power_print_stats
+* 说    明: 打印当前模式、各模式累计驻留时间与切换次数
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void gps_power_print_stats(void)
+{
+    gps_power_stats_t stats;
+
+    gps_power_get_stats(&stats);
+    printf("[gps_power] mode=%d active=%u periodic=%u standby=%u s transitions=%u\n", stats.mode,
+           (unsigned)(stats.residency_ms[GPS_PWR_ACTIVE] / 1000),
+           (unsigned)(stats.residency_ms[GPS_PWR_PERIODIC] / 1000),
+           (unsigned)(stats.residency_ms[GPS_PWR_STANDBY] / 1000), (unsigned)stats.transitions);
+}
@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "cmsis_os2.h"
+#include "gps_track.h"
+
+#define GPS_TRACK_VERSION       1
+#define GPS_TRACK_M_PER_E7      0.011132f
+#define GPS_TRACK_POINT_MAX     15      // 单点编码的最大字节数（3 个 5 字节变长整数）
+
+/***********************************************************************
+* 结构体名称: gps_track_point_t
+* 说    明: 轨迹点
+************************************************************************/
+typedef struct
+{
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t t_s;           // 启动以来的秒数
+    uint32_t utc_date;
+    uint32_t utc_time;
+} gps_track_point_t;
+
+static gps_track_point_t g_anchor;          // 最近保留的点，也是窗口折线的起点
+static gps_track_point_t g_last;            // 最近实际写入段中的点，g_prev_* 即其编码值；段满丢点时不更新
+static int g_has_anchor = 0;
+static gps_track_point_t g_window[GPS_TRACK_WINDOW];
+static int g_window_len = 0;
+static uint8_t g_seg[GPS_TRACK_SEG_BYTES];
+static int g_seg_len = 0;
+static int g_seg_points = 0;
+static uint32_t g_seg_open_ms = 0;
+static int32_t g_prev_lat_e6;
+static int32_t g_prev_lon_e6;
+static uint32_t g_prev_t_s;
+static gps_track_point_t g_enc_last;        // 已编码待确认部分的最后一点，确认后作为下一段起点
+static int g_enc_len = 0;                   // 已编码待确认的字节数，0 表示没有待确认的编码
+static int g_enc_points = 0;
+static gps_track_stats_t g_stats;
+static osMutexId_t g_track_mutex = NULL;
+
+static const char g_b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/***********************************************************************
+* 函数名称: gps_track_e6
+* 说    明: 1e-7 度四舍五入为 1e-6 度（约 0.1 米），缩短编码
+* 参    数: e7：1e-7 度
+* 返 回 值: 1e-6 度
+************************************************************************/
+static int32_t gps_track_e6(int32_t e7)
+{
+    return (e7 >= 0) ? (e7 + 5) / 10 : (e7 - 5) / 10;
+}
+
+static uint32_t gps_track_zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int gps_track_varint_len(uint32_t v)
+{
+    int n = 1;
+
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+/***********************************************************************
+* 函数名称: gps_track_put_varint
+* 说    明: 以 LEB128 变长整数追加到轨迹段
+* 参    数: v：数值
+* 返 回 值: 无
+************************************************************************/
+static void gps_track_put_varint(uint32_t v)
+{
+    while (v >= 0x80) {
+        g_seg[g_seg_len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    g_seg[g_seg_len++] = (uint8_t)v;
+}
+
+static void gps_track_put_zigzag(int32_t v)
+{
+    gps_track_put_varint(gps_track_zigzag(v));
+}
+
+/***********************************************************************
+* 函数名称: gps_track_header_len
+* 说    明: 以该点为起点的段头部的编码长度
+* 参    数: p：起点
+* 返 回 值: 字节数
+************************************************************************/
+static int gps_track_header_len(const gps_track_point_t *p)
+{
+    return 1 + gps_track_varint_len(p->utc_date) + gps_track_varint_len(p->utc_time) +
+           gps_track_varint_len(gps_track_zigzag(gps_track_e6(p->lat_e7))) +
+           gps_track_varint_len(gps_track_zigzag(gps_track_e6(p->lon_e7)));
+}
+
+/***********************************************************************
+* 函数名称: gps_track_put_header
+* 说    明: 在段首写入头部，调用前 g_seg_len 为 0
+* 参    数: p：起点
+* 返 回 值: 无
+************************************************************************/
+static void gps_track_put_header(const gps_track_point_t *p)
+{
+    g_seg[g_seg_len++] = GPS_TRACK_VERSION;
+    gps_track_put_varint(p->utc_date);
+    gps_track_put_varint(p->utc_time);
+    gps_track_put_zigzag(gps_track_e6(p->lat_e7));
+    gps_track_put_zigzag(gps_track_e6(p->lon_e7));
+}
+
+/***********************************************************************
+* 函数名称: gps_track_emit
+* 说    明: 把保留下来的点编码进当前轨迹段，段为空时先写头部
+* 参    数: p：轨迹点
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+static void gps_track_emit(const gps_track_point_t *p, uint32_t now_ms)
+{
+    int32_t lat_e6 = gps_track_e6(p->lat_e7);
+    int32_t lon_e6 = gps_track_e6(p->lon_e7);
+
+    g_anchor = *p;
+    if (g_seg_len == 0) {
+        gps_track_put_header(p);
+        g_seg_open_ms = now_ms;
+        g_seg_points = 0;
+    } else if (g_seg_len + GPS_TRACK_POINT_MAX > GPS_TRACK_SEG_BYTES) {
+        g_stats.points_dropped++;   // 长时间无法上传，等待取走后再继续记录
+        return;
+    } else {
+        gps_track_put_varint(p->t_s - g_prev_t_s);
+        gps_track_put_zigzag(lat_e6 - g_prev_lat_e6);
+        gps_track_put_zigzag(lon_e6 - g_prev_lon_e6);
+    }
+    g_last = *p;
+    g_prev_lat_e6 = lat_e6;
+    g_prev_lon_e6 = lon_e6;
+    g_prev_t_s = p->t_s;
+    g_seg_points++;
+    g_stats.points_kept++;
+}
+
+/***********************************************************************
+* 函数名称: gps_track_deviation_m
+* 说    明: 点到线段 a-b 的距离，以 a 为原点的局部平面近似
+* 参    数: a / b：线段端点
+*           p：点
+* 返 回 值: 距离（米）
+************************************************************************/
+static float gps_track_deviation_m(const gps_track_point_t *a, const gps_track_point_t *b,
+                                   const gps_track_point_t *p)
+{
+    float k = GPS_TRACK_M_PER_E7 * cosf((float)a->lat_e7 * (float)(M_PI / 180.0 / 1e7));
+    float bx = (float)((int64_t)b->lon_e7 - a->lon_e7) * k;
+    float by = (float)((int64_t)b->lat_e7 - a->lat_e7) * GPS_TRACK_M_PER_E7;
+    float px = (float)((int64_t)p->lon_e7 - a->lon_e7) * k;
+    float py = (float)((int64_t)p->lat_e7 - a->lat_e7) * GPS_TRACK_M_PER_E7;
+    float len2 = bx * bx + by * by;
+    float t = (len2 > 0.0f) ? (px * bx + py * by) / len2 : 0.0f;
+
+    if (t < 0.0f) {
+        t = 0.0f;
+    } else if (t > 1.0f) {
+        t = 1.0f;
+    }
+    float dx = px - t * bx;
+    float dy = py - t * by;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/***********************************************************************
+* 函数名称: gps_track_init
+* 说    明: 初始化轨迹缓存
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int gps_track_init(void)
+{
+    if (g_track_mutex == NULL) {
+        g_track_mutex = osMutexNew(NULL);
+        if (g_track_mutex == NULL) {
+            printf("[gps_track] Failed to create mutex!\n");
+            return -1;
+        }
+    }
+    g_has_anchor = 0;
+    g_window_len = 0;
+    g_seg_len = 0;
+    g_enc_len = 0;
+    memset(&g_stats, 0, sizeof(g_stats));
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: gps_track_add
+* 说    明: 加入一个定位点，做滑动窗口误差限定的在线简化：
+*           窗口内所有点到“保留点 - 新点”线段的距离都不超过 GPS_TRACK_TOLERANCE_M 时
+*           继续扩大窗口；否则保留窗口末点并以它为新的起点
+* 参    数: lat_e7 / lon_e7：位置（1e-7 度）
+*           now_ms：当前时间戳
+*           utc_date / utc_time：定位的 UTC 日期（ddmmyy）与时间（hhmmss）
+* 返 回 值: 无
+************************************************************************/
+void gps_track_add(int32_t lat_e7, int32_t lon_e7, uint32_t now_ms, uint32_t utc_date, uint32_t utc_time)
+{
+    gps_track_point_t p = { lat_e7, lon_e7, now_ms / 1000, utc_date, utc_time };
+
+    if (g_track_mutex == NULL) {
+        return;
+    }
+    osMutexAcquire(g_track_mutex, osWaitForever);
+    g_stats.points_in++;
+    if (!g_has_anchor) {
+        g_has_anchor = 1;
+        gps_track_emit(&p, now_ms);
+        osMutexRelease(g_track_mutex);
+        return;
+    }
+
+    int keep = (g_window_len >= GPS_TRACK_WINDOW);
+    for (int i = 0; i < g_window_len && !keep; i++) {
+        keep = gps_track_deviation_m(&g_anchor, &p, &g_window[i]) > GPS_TRACK_TOLERANCE_M;
+    }
+    if (keep) {
+        gps_track_emit(&g_window[g_window_len - 1], now_ms);
+        g_window_len = 0;
+    }
+    g_window[g_window_len++] = p;
+    osMutexRelease(g_track_mutex);
+}
+
+/***********************************************************************
+* 函数名称: gps_track_due
+* 说    明: 判断当前轨迹段是否应当上传（到达上传间隔或缓存将满）
+* 参    数: now_ms：当前时间戳
+* 返 回 值: 1 应上传，0 不需要
+************************************************************************/
+int gps_track_due(uint32_t now_ms)
+{
+    if (g_seg_points < 2 && g_window_len == 0) {
+        return 0;       // 只有起点，没有新的移动
+    }
+    return (now_ms - g_seg_open_ms >= GPS_TRACK_UPLOAD_MS) || (g_seg_len >= GPS_TRACK_SEG_BYTES * 3 / 4);
+}
+
+/***********************************************************************
+* 函数名称: gps_track_encode
+* 说    明: 把当前轨迹段做 base64 编码，段内容保留到 gps_track_commit 确认上传成功为止，
+*           上传失败时下次编码会包含这段与之后新增的点。先把窗口末点写入段中，
+*           确认后下一段以它为起点，保证相邻段首尾相接
+* 参    数: out：输出缓存，至少 GPS_TRACK_B64_SIZE 字节
+*           out_len：缓存大小
+*           now_ms：当前时间戳
+* 返 回 值: 编码后的字符数，无数据或缓存不足返回 0
+************************************************************************/
+int gps_track_encode(char *out, int out_len, uint32_t now_ms)
+{
+    int n = 0;
+
+    if (g_track_mutex == NULL || out_len < GPS_TRACK_B64_SIZE) {
+        return 0;
+    }
+    osMutexAcquire(g_track_mutex, osWaitForever);
+    if (g_window_len > 0) {
+        gps_track_emit(&g_window[g_window_len - 1], now_ms);
+        g_window_len = 0;
+    }
+    for (int i = 0; i < g_seg_len; i += 3) {
+        uint32_t v = (uint32_t)g_seg[i] << 16;
+        if (i + 1 < g_seg_len) {
+            v |= (uint32_t)g_seg[i + 1] << 8;
+        }
+        if (i + 2 < g_seg_len) {
+            v |= g_seg[i + 2];
+        }
+        out[n++] = g_b64[(v >> 18) & 0x3F];
+        out[n++] = g_b64[(v >> 12) & 0x3F];
+        out[n++] = (i + 1 < g_seg_len) ? g_b64[(v >> 6) & 0x3F] : '=';
+        out[n++] = (i + 2 < g_seg_len) ? g_b64[v & 0x3F] : '=';
+    }
+    out[n] = '\0';
+    g_enc_len = g_seg_len;
+    g_enc_points = g_seg_points;
+    g_enc_last = g_last;
+    osMutexRelease(g_track_mutex);
+    return n;
+}
+
+/***********************************************************************
+* 函数名称: gps_track_commit
+* 说    明: 确认上次编码的内容已上传：从段中移除这部分，以其最后一点为新段起点，
+*           上传期间新增的点（相对该点的差分）接在新头部之后
+* 参    数: now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+void gps_track_commit(uint32_t now_ms)
+{
+    if (g_track_mutex == NULL) {
+        return;
+    }
+    osMutexAcquire(g_track_mutex, osWaitForever);
+    if (g_enc_len > 0 && g_enc_len <= g_seg_len) {
+        int tail = g_seg_len - g_enc_len;
+        int head = gps_track_header_len(&g_enc_last);
+
+        if (head + tail > GPS_TRACK_SEG_BYTES) {
+            g_stats.points_dropped += g_seg_points - g_enc_points;
+            tail = 0;
+            g_seg_points = g_enc_points;
+            g_prev_lat_e6 = gps_track_e6(g_enc_last.lat_e7);
+            g_prev_lon_e6 = gps_track_e6(g_enc_last.lon_e7);
+            g_prev_t_s = g_enc_last.t_s;
+            g_last = g_enc_last;
+        }
+        memmove(&g_seg[head], &g_seg[g_enc_len], tail);
+        g_seg_len = 0;
+        gps_track_put_header(&g_enc_last);
+        g_seg_len += tail;
+        g_seg_points = 1 + g_seg_points - g_enc_points;
+        g_seg_open_ms = now_ms;
+        g_stats.segments++;
+    }
+    g_enc_len = 0;
+    osMutexRelease(g_track_mutex);
+}
+
+/***********************************************************************
+* 函数名称: gps_track_get_stats
+* 说    明: 获取轨迹压缩统计
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void gps_track_get_stats(gps_track_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <string.h>
+#include "hi_uart.h"
+#include "cmsis_os2.h"
+#include "gps_uart.h"
+#include "gps.h"
+
+#define GPS_UART_FLAG_RX        0x0001U
+#define GPS_UART_FLAG_RESUME    0x0002U
+#define GPS_UART_RING_MASK  (GPS_UART_RING_SIZE - 1)
+#define GPS_UART_PAUSE_TIMEOUT_MS   200     // 切换波特率时等待接收任务暂停的最长时间
+
+/*
+ * 单生产者（接收任务）/单消费者（NMEA 解析）无锁环形缓冲：
+ * head 只由生产者写，tail 只由消费者写，二者都单调递增，按掩码取下标。
+ */
+static uint8_t g_rx_ring[GPS_UART_RING_SIZE];
+static volatile uint32_t g_rx_head = 0;
+static volatile uint32_t g_rx_tail = 0;
+static osEventFlagsId_t g_rx_event = NULL;
+static gps_uart_stats_t g_stats;
+static volatile int g_pause_req = 0;
+static volatile int g_paused = 0;
+static uint32_t g_baud_rate = GPS_DEFAULT_BAUD;
+
+/***********************************************************************
+* 函数名称: gps_uart_ms_to_ticks
+* 说    明: 毫秒换算为系统节拍，向上取整且至少 1 个节拍
+* 参    数: ms：毫秒
+* 返 回 值: 节拍数
+************************************************************************/
+static uint32_t gps_uart_ms_to_ticks(uint32_t ms)
+{
+    uint32_t ticks = (uint32_t)(((uint64_t)ms * osKernelGetTickFreq() + 999) / 1000);
+
+    return ticks > 0 ? ticks : 1;
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_ring_push
+* 说    明: 生产者写入环形缓冲，空间不足时丢弃多出的字节并计入溢出
+* 参    数: data：数据
+*           len：长度
+* 返 回 值: 实际写入的字节数
+************************************************************************/
+static int gps_uart_ring_push(const uint8_t *data, int len)
+{
+    uint32_t head = g_rx_head;
+    uint32_t space = GPS_UART_RING_SIZE - (head - g_rx_tail);
+    int n = (len > (int)space) ? (int)space : len;
+
+    for (int i = 0; i < n; i++) {
+        g_rx_ring[(head + i) & GPS_UART_RING_MASK] = data[i];
+    }
+    __sync_synchronize();
+    g_rx_head = head + n;
+
+    g_stats.rx_bytes += n;
+    g_stats.ring_overruns += len - n;
+    if (g_rx_head - g_rx_tail > g_stats.ring_peak) {
+        g_stats.ring_peak = g_rx_head - g_rx_tail;
+    }
+    return n;
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_rx_task
+* 说    明: 串口接收任务。UART1 工作在阻塞模式，驱动由 RX FIFO 水线中断
+*           和接收超时（线路空闲）中断唤醒本任务，无需轮询；
+*           每收到一段数据就放入环形缓冲并唤醒消费者；
+*           切换波特率期间暂停在 RESUME 事件上
+* 参    数: arg：未使用
+* 返 回 值: 无
+************************************************************************/
+static void gps_uart_rx_task(void *arg)
+{
+    (void)arg;
+    uint8_t chunk[GPS_UART_CHUNK_SIZE];
+
+    while (1) {
+        if (g_pause_req) {
+            g_paused = 1;
+            osEventFlagsWait(g_rx_event, GPS_UART_FLAG_RESUME, osFlagsWaitAny, osWaitForever);
+            g_paused = 0;
+            continue;
+        }
+        int len = hi_uart_read(HI_UART_IDX_1, chunk, sizeof(chunk));
+        if (len <= 0) {
+            if (g_pause_req) {
+                continue;
+            }
+            g_stats.read_errors++;
+            osDelay(10);
+            continue;
+        }
+        g_stats.rx_bursts++;
+        gps_uart_ring_push(chunk, len);
+        osEventFlagsSet(g_rx_event, GPS_UART_FLAG_RX);
+    }
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_start
+* 说    明: 创建接收事件与接收任务，需在 Uart1Config 之后调用
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int gps_uart_start(void)
+{
+    osThreadAttr_t attr;
+
+    if (g_rx_event != NULL) {
+        return 0;
+    }
+    g_rx_event = osEventFlagsNew(NULL);
+    if (g_rx_event == NULL) {
+        printf("[gps_uart] Failed to create event flags!\n");
+        return -1;
+    }
+
+    attr.name = "gps_uart_rx";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = GPS_UART_TASK_STACK;
+    attr.priority = GPS_UART_TASK_PRIO;
+
+    if (osThreadNew((osThreadFunc_t)gps_uart_rx_task, NULL, &attr) == NULL) {
+        printf("[gps_uart] Failed to create gps_uart_rx!\n");
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_set_baud
+* 说    明: 修改 UART1 波特率：先让接收任务退出阻塞读并暂停，
+*           重新初始化串口后再恢复接收。
+*           接收任务未响应时撤销暂停请求并补发 RESUME：接收任务可能在撤销前
+*           已看到请求，随后才进入暂停，补发的事件保证它不会一直停在那里
+* 参    数: baud_rate：新的波特率
+* 返 回 值: 0 成功，-1 接收任务未响应暂停
+************************************************************************/
+int gps_uart_set_baud(uint32_t baud_rate)
+{
+    uint32_t max_ticks = gps_uart_ms_to_ticks(GPS_UART_PAUSE_TIMEOUT_MS);
+    uint32_t wait_ticks = 0;
+
+    if (g_rx_event == NULL) {
+        return -1;
+    }
+    osEventFlagsClear(g_rx_event, GPS_UART_FLAG_RESUME);    // 清除上次失败时补发但未被消费的事件
+    g_pause_req = 1;
+    while (!g_paused) {
+        hi_uart_quit_read(HI_UART_IDX_1);
+        osDelay(1);
+        if (++wait_ticks > max_ticks) {
+            g_pause_req = 0;
+            osEventFlagsSet(g_rx_event, GPS_UART_FLAG_RESUME);
+            return -1;
+        }
+    }
+    hi_uart_deinit(HI_UART_IDX_1);
+    Uart1Config(baud_rate);
+    g_baud_rate = baud_rate;
+    g_pause_req = 0;
+    osEventFlagsSet(g_rx_event, GPS_UART_FLAG_RESUME);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_get_baud
+* 说    明: 获取 UART1 当前波特率
+* 参    数: 无
+* 返 回 值: 波特率
+************************************************************************/
+uint32_t gps_uart_get_baud(void)
+{
+    return g_baud_rate;
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_read
+* 说    明: 消费者从环形缓冲取数据；缓冲为空时阻塞等待接收任务唤醒
+* 参    数: buf：输出缓存
+*           len：缓存大小
+*           timeout_ms：缓冲为空时的最长等待时间（毫秒）
+* 返 回 值: 实际读取的字节数，0 表示超时
+************************************************************************/
+int gps_uart_read(uint8_t *buf, int len, uint32_t timeout_ms)
+{
+    uint32_t tail = g_rx_tail;
+    uint32_t avail = g_rx_head - tail;
+
+    while (avail == 0) {
+        if (g_rx_event == NULL) {
+            return 0;
+        }
+        uint32_t flags = osEventFlagsWait(g_rx_event, GPS_UART_FLAG_RX, osFlagsWaitAny,
+                                          (timeout_ms == osWaitForever) ? osWaitForever :
+                                          gps_uart_ms_to_ticks(timeout_ms));
+        if (flags & osFlagsError) {
+            return 0;
+        }
+        avail = g_rx_head - tail;
+    }
+    __sync_synchronize();
+
+    int n = (len > (int)avail) ? (int)avail : len;
+    for (int i = 0; i < n; i++) {
+        buf[i] = g_rx_ring[(tail + i) & GPS_UART_RING_MASK];
+    }
+    g_rx_tail = tail + n;
+    return n;
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_write
+* 说    明: 向 GPS 模块发送数据（配置命令等）
+* 参    数: buf：数据
+*           len：长度
+* 返 回 值: 实际发送的字节数，失败返回 -1
+************************************************************************/
+int gps_uart_write(const uint8_t *buf, int len)
+{
+    return hi_uart_write(HI_UART_IDX_1, buf, (unsigned int)len);
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_get_stats
+* 说    明: 获取接收统计
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void gps_uart_get_stats(gps_uart_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
+
+/***********************************************************************
+* 函数名称: gps_uart_print_stats
+* 说    明: 打印接收统计
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void gps_uart_print_stats(void)
+{
+    gps_uart_stats_t stats;
+
+    gps_uart_get_stats(&stats);
+    printf("[gps_uart] baud=%u rx=%u bytes bursts=%u ring peak=%u/%u overruns=%u read_errors=%u\n",
+           (unsigned)g_baud_rate, (unsigned)stats.rx_bytes, (unsigned)stats.rx_bursts,
+           (unsigned)stats.ring_peak, (unsigned)GPS_UART_RING_SIZE, (unsigned)stats.ring_overruns,
+           (unsigned)stats.read_errors);
+}
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
+#include "param_store.h"
 
 #ifndef __HI_TASK_TYPEDEF_FIX
 #define __HI_TASK_TYPEDEF_FIX
@@ -97,7 +98,7 @@ int interval_to_hr(int interval_ms) {
 * 返 回 值: 无（打印状态信息）
 ************************************************************************/
 void simple_mood_estimate(int current_hr, double hrv) {
-    const int baseline_hr = 70;
+    const int baseline_hr = param_get_int(PARAM_HRV_BASELINE_HR);   // 静息心率基线，可由平台调整
     const double hrv_threshold = 20.0;
 
     const char* mood;
@@ -302,14 +303,13 @@ int cir_hs(void)
 }
 
 /***********************************************************************
-* 函数名称: max30102_Task
-* 功    能: MAX30102任务主循环，持续采集心率/血氧数据
-* 参    数: arg - 任务参数（默认NULL）
-* 返 回 值: NULL（任务结束后返回）
+* 函数名称: max30102_app_setup
+* 功    能: 初始化传感器并检查器件 ID
+* 参    数: 无
+* 返 回 值: 无
 ************************************************************************/
-void *max30102_Task(void *arg)
+void max30102_app_setup(void)
 {
-    (void)arg;
     printf("Starting max30102_Init\n");
     max30102_Init();
     printf("max30102 Init Ending!\n");
@@ -321,29 +321,52 @@ void *max30102_Task(void *arg)
     if(id != 0x15) {
         printf("Warning: MAX30102 Part ID mismatch! Check wiring and power.\n");
     }
+}
+
+/***********************************************************************
+* 函数名称: max30102_app_sample
+* 功    能: 采集一个样本并更新心率/血氧，需每 SAMPLE_INTERVAL_MS 调用一次；
+*           连续失败时复位传感器
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void max30102_app_sample(void)
+{
+    static int failure_count = 0;
+
+    if (cir_hs() != 0) {
+        failure_count++;
+        printf("Warning: Heart rate calculation failed! Count: %d\n", failure_count);
+
+        if (failure_count >= 10) {
+            printf("Error: Too many failures, resetting sensor...\n");
+            max30102_Init();
+            failure_count = 0;
+        }
+    } else {
+        failure_count = 0;
+    }
+}
+
+/***********************************************************************
+* 函数名称: max30102_Task
+* 功    能: MAX30102任务主循环，持续采集心率/血氧数据
+* 参    数: arg - 任务参数（默认NULL）
+* 返 回 值: NULL（任务结束后返回）
+************************************************************************/
+void *max30102_Task(void *arg)
+{
+    (void)arg;
+    max30102_app_setup();
 
-    int failure_count = 0;
-    
     while (1) {
         static int stack_check_counter = 0;
         if (++stack_check_counter >= 100) {
             stack_check_counter = 0;
             uint32_t stack_usage = get_current_stack_usage();
         }
-        
-        if (cir_hs() != 0) {
-            failure_count++;
-            printf("Warning: Heart rate calculation failed! Count: %d\n", failure_count);
-            
-            if (failure_count >= 10) {
-                printf("Error: Too many failures, resetting sensor...\n");
-                max30102_Init();
-                failure_count = 0;
-            }
-        } else {
-            failure_count = 0;
-        }
-        
+
+        max30102_app_sample();
         hi_sleep(SAMPLE_INTERVAL_MS);
     }
 
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include "mem_pool.h"
+
+/***********************************************************************
+* 函数名称: mem_pool_init
+* 说    明: 初始化内存池，把所有块串入空闲链表
+* 参    数: pool：内存池
+*           base：块存储区，至少 block_size * count 字节
+*           block_size：块大小
+*           count：块数
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int mem_pool_init(mem_pool_t *pool, void *base, uint16_t block_size, uint16_t count)
+{
+    if (block_size < sizeof(void *) || (block_size % sizeof(void *)) != 0 || count == 0) {
+        return -1;
+    }
+    pool->mutex = osMutexNew(NULL);
+    pool->free_sem = osSemaphoreNew(count, count, NULL);
+    if (pool->mutex == NULL || pool->free_sem == NULL) {
+        printf("[mem_pool] Failed to create mutex!\n");
+        return -1;
+    }
+    pool->base = (uint8_t *)base;
+    pool->block_size = block_size;
+    pool->count = count;
+    pool->in_use = 0;
+    pool->peak = 0;
+    pool->alloc_fail = 0;
+    pool->free_head = NULL;
+    for (int i = count - 1; i >= 0; i--) {
+        void **block = (void **)(pool->base + (uint32_t)i * block_size);
+        *block = pool->free_head;
+        pool->free_head = block;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: mem_pool_alloc_timeout
+* 说    明: 从内存池取一个块，池已耗尽时最多等待 timeout 个节拍
+* 参    数: pool：内存池
+*           timeout：等待节拍数，0 不等待，osWaitForever 一直等待
+* 返 回 值: 块地址，超时返回 NULL
+************************************************************************/
+void *mem_pool_alloc_timeout(mem_pool_t *pool, uint32_t timeout)
+{
+    void **block;
+
+    if (osSemaphoreAcquire(pool->free_sem, timeout) != osOK) {
+        osMutexAcquire(pool->mutex, osWaitForever);
+        pool->alloc_fail++;
+        osMutexRelease(pool->mutex);
+        return NULL;
+    }
+    osMutexAcquire(pool->mutex, osWaitForever);
+    block = (void **)pool->free_head;
+    pool->free_head = *block;
+    if (++pool->in_use > pool->peak) {
+        pool->peak = pool->in_use;
+    }
+    osMutexRelease(pool->mutex);
+    return block;
+}
+
+/***********************************************************************
+* 函数名称: mem_pool_alloc
+* 说    明: 从内存池取一个块，不等待
+* 参    数: pool：内存池
+* 返 回 值: 块地址，池已耗尽返回 NULL
+************************************************************************/
+void *mem_pool_alloc(mem_pool_t *pool)
+{
+    return mem_pool_alloc_timeout(pool, 0);
+}
+
+/***********************************************************************
+* 函数名称: mem_pool_free
+* 说    明: 把块还给内存池
+* 参    数: pool：内存池
+*           block：mem_pool_alloc 取得的块，NULL 时忽略
+* 返 回 值: 无
+************************************************************************/
+void mem_pool_free(mem_pool_t *pool, void *block)
+{
+    uint32_t offset;
+
+    if (block == NULL) {
+        return;
+    }
+    offset = (uint32_t)((uint8_t *)block - pool->base);
+    if ((uint8_t *)block < pool->base || offset >= (uint32_t)pool->block_size * pool->count ||
+        offset % pool->block_size != 0) {
+        printf("[mem_pool] bad free %p\n", block);
+        return;
+    }
+    osMutexAcquire(pool->mutex, osWaitForever);
+    *(void **)block = pool->free_head;
+    pool->free_head = block;
+    pool->in_use--;
+    osMutexRelease(pool->mutex);
+    (void)osSemaphoreRelease(pool->free_sem);
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include "hi_time.h"
+#include "msg_lane.h"
+
+/***********************************************************************
+* 函数名称: msg_lane_init
+* 说    明: 初始化通道
+* 参    数: lane：通道
+*           name：名称，用于统计输出
+*           capacity：队列容量，不超过 MSG_LANE_MAX_DEPTH
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int msg_lane_init(msg_lane_t *lane, const char *name, uint8_t capacity)
+{
+    if (capacity == 0 || capacity > MSG_LANE_MAX_DEPTH) {
+        return -1;
+    }
+    lane->mutex = osMutexNew(NULL);
+    if (lane->mutex == NULL) {
+        printf("[lane] Failed to create mutex!\n");
+        return -1;
+    }
+    lane->name = name;
+    lane->capacity = capacity;
+    lane->head = 0;
+    lane->count = 0;
+    lane->depth_peak = 0;
+    lane->posted = 0;
+    lane->coalesced = 0;
+    lane->dropped = 0;
+    lane->taken = 0;
+    lane->latency_total_ms = 0;
+    lane->latency_max_ms = 0;
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: msg_lane_put
+* 说    明: 消息入队。队列已满时，若提供了合并函数，从最新的消息往前找一条
+*           可合并的消息，把新消息合并进去（保留原入队时刻）
+* 参    数: lane：通道
+*           msg：消息
+*           merge：合并函数，NULL 表示不合并
+* 返 回 值: 0 已入队，1 已合并（msg 仍归调用方，可释放），-1 队列满被拒绝
+************************************************************************/
+int msg_lane_put(msg_lane_t *lane, void *msg, msg_lane_merge_t merge)
+{
+    int ret = -1;
+
+    osMutexAcquire(lane->mutex, osWaitForever);
+    if (lane->count < lane->capacity) {
+        uint8_t tail = (uint8_t)((lane->head + lane->count) % lane->capacity);
+        lane->slots[tail] = msg;
+        lane->post_ms[tail] = hi_get_milli_seconds();
+        lane->count++;
+        lane->posted++;
+        if (lane->count > lane->depth_peak) {
+            lane->depth_peak = lane->count;
+        }
+        ret = 0;
+    } else if (merge != NULL) {
+        for (int i = lane->count - 1; i >= 0; i--) {
+            if (merge(lane->slots[(lane->head + i) % lane->capacity], msg)) {
+                lane->coalesced++;
+                ret = 1;
+                break;
+            }
+        }
+    }
+    if (ret < 0) {
+        lane->dropped++;
+    }
+    osMutexRelease(lane->mutex);
+    return ret;
+}
+
+/***********************************************************************
+* 函数名称: msg_lane_get
+* 说    明: 取出最早入队的消息并记录其等待时间
+* 参    数: lane：通道
+* 返 回 值: 消息，队列为空返回 NULL
+************************************************************************/
+void *msg_lane_get(msg_lane_t *lane)
+{
+    void *msg = NULL;
+
+    osMutexAcquire(lane->mutex, osWaitForever);
+    if (lane->count > 0) {
+        uint32_t latency = hi_get_milli_seconds() - lane->post_ms[lane->head];
+        msg = lane->slots[lane->head];
+        lane->head = (uint8_t)((lane->head + 1) % lane->capacity);
+        lane->count--;
+        lane->taken++;
+        lane->latency_total_ms += latency;
+        if (latency > lane->latency_max_ms) {
+            lane->latency_max_ms = latency;
+        }
+    }
+    osMutexRelease(lane->mutex);
+    return msg;
+}
+
+/***********************************************************************
+* 函数名称: msg_lane_print_stats
+* 说    明: 打印通道深度与等待时间统计
+* 参    数: lane：通道
+* 返 回 值: 无
+************************************************************************/
+void msg_lane_print_stats(const msg_lane_t *lane)
+{
+    printf("[lane] %s depth=%u peak=%u/%u posted=%u coalesced=%u dropped=%u latency avg=%u max=%u ms\n",
+           lane->name, lane->count, lane->depth_peak, lane->capacity, (unsigned)lane->posted,
+           (unsigned)lane->coalesced, (unsigned)lane->dropped,
+           (unsigned)(lane->taken ? lane->latency_total_ms / lane->taken : 0), (unsigned)lane->latency_max_ms);
+}
@@ -0,0 +1,446 @@
+#include <stdio.h>
+#include <string.h>
+#include "nmea_parser.h"
+
+enum
+{
+    NMEA_STATE_IDLE = 0,    // 等待 '$'
+    NMEA_STATE_BODY,        // 接收语句字段
+    NMEA_STATE_CHECKSUM,    // 接收 '*' 之后的校验字节
+};
+
+/***********************************************************************
+* 函数名称: nmea_parse_double
+* 说    明: 原地解析十进制小数字段（不依赖 atof，也不拷贝字段）
+* 参    数: s：以 '\0' 结尾的字段
+* 返 回 值: 解析结果，空字段返回 0
+************************************************************************/
+static double nmea_parse_double(const char *s)
+{
+    double value = 0.0;
+    double scale = 1.0;
+    int negative = 0;
+
+    if (*s == '-') {
+        negative = 1;
+        s++;
+    }
+    while (*s >= '0' && *s <= '9') {
+        value = value * 10.0 + (*s++ - '0');
+    }
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9') {
+            value = value * 10.0 + (*s++ - '0');
+            scale *= 10.0;
+        }
+    }
+    value /= scale;
+    return negative ? -value : value;
+}
+
+/***********************************************************************
+* 函数名称: nmea_parse_uint
+* 说    明: 原地解析无符号整数字段，遇到非数字字符（如小数点）即停止
+* 参    数: s：以 '\0' 结尾的字段
+* 返 回 值: 解析结果
+************************************************************************/
+static uint32_t nmea_parse_uint(const char *s)
+{
+    uint32_t value = 0;
+    while (*s >= '0' && *s <= '9') {
+        value = value * 10 + (uint32_t)(*s++ - '0');
+    }
+    return value;
+}
+
+/***********************************************************************
+* 函数名称: nmea_dm_to_e7
+* 说    明: 将 ddmm.mmmm 度分格式转换为 1e-7 度，全程整数运算：
+*           分保留 6 位小数，1e-7 度 = 分(1e-6) * 10 / 60 = 分(1e-6) / 6
+* 参    数: s：以 '\0' 结尾的度分字段
+* 返 回 值: 1e-7 度
+************************************************************************/
+static int32_t nmea_dm_to_e7(const char *s)
+{
+    uint32_t whole = 0;
+    uint32_t frac = 0;
+    int digits = 0;
+
+    while (*s >= '0' && *s <= '9') {
+        whole = whole * 10 + (uint32_t)(*s++ - '0');
+    }
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9') {
+            if (digits < 6) {
+                frac = frac * 10 + (uint32_t)(*s - '0');
+                digits++;
+            }
+            s++;
+        }
+    }
+    while (digits < 6) {
+        frac *= 10;
+        digits++;
+    }
+    uint32_t min_e6 = (whole % 100) * 1000000U + frac;
+    return (int32_t)((whole / 100) * 10000000U + (min_e6 + 3U) / 6U);
+}
+
+/***********************************************************************
+* 函数名称: nmea_hex
+* 说    明: 十六进制字符转数值
+* 参    数: c：字符
+* 返 回 值: 0~15，非法字符返回 -1
+************************************************************************/
+static int nmea_hex(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static const char *nmea_field(const nmea_parser_t *p, int idx)
+{
+    return (idx < p->field_count) ? &p->buf[p->field[idx]] : "";
+}
+
+/***********************************************************************
+* 函数名称: nmea_parse_coord
+* 说    明: 解析度分字段并按半球字段（N/S、E/W）加上符号
+* 参    数: dm：度分字段
+*           hemi：半球字段
+* 返 回 值: 带符号的 1e-7 度
+************************************************************************/
+static int32_t nmea_parse_coord(const char *dm, const char *hemi)
+{
+    int32_t deg = nmea_dm_to_e7(dm);
+    return (*hemi == 'S' || *hemi == 'W') ? -deg : deg;
+}
+
+/***********************************************************************
+* 函数名称: nmea_handle_gga
+* 说    明: 处理 xxGGA 语句，更新定位结果并回调
+* 参    数: p：解析器
+* 返 回 值: 无
+************************************************************************/
+static void nmea_handle_gga(nmea_parser_t *p)
+{
+    nmea_fix_t *fix = &p->fix;
+
+    if (p->field_count < 10) {
+        return;
+    }
+    fix->utc_time = nmea_parse_uint(nmea_field(p, 1));
+    fix->quality = (uint8_t)nmea_parse_uint(nmea_field(p, 6));
+    if (fix->quality != 0) {
+        fix->lat_e7 = nmea_parse_coord(nmea_field(p, 2), nmea_field(p, 3));
+        fix->lon_e7 = nmea_parse_coord(nmea_field(p, 4), nmea_field(p, 5));
+        fix->altitude = (float)nmea_parse_double(nmea_field(p, 9));
+    }
+    fix->satellites = (uint8_t)nmea_parse_uint(nmea_field(p, 7));
+    fix->hdop = (float)nmea_parse_double(nmea_field(p, 8));
+
+    if (p->cb != NULL) {
+        p->cb(fix, NMEA_SENTENCE_GGA, p->cb_arg);
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_handle_rmc
+* 说    明: 处理 xxRMC 语句：UTC 日期时间、状态、位置、速度、航向
+* 参    数: p：解析器
+* 返 回 值: 无
+************************************************************************/
+static void nmea_handle_rmc(nmea_parser_t *p)
+{
+    nmea_fix_t *fix = &p->fix;
+
+    if (p->field_count < 10) {
+        return;
+    }
+    fix->utc_time = nmea_parse_uint(nmea_field(p, 1));
+    fix->utc_date = nmea_parse_uint(nmea_field(p, 9));
+    fix->rmc_valid = (*nmea_field(p, 2) == 'A');
+    if (fix->rmc_valid) {
+        fix->lat_e7 = nmea_parse_coord(nmea_field(p, 3), nmea_field(p, 4));
+        fix->lon_e7 = nmea_parse_coord(nmea_field(p, 5), nmea_field(p, 6));
+        fix->speed_kmh = (float)(nmea_parse_double(nmea_field(p, 7)) * 1.852);
+        fix->course = (float)nmea_parse_double(nmea_field(p, 8));
+    }
+
+    if (p->cb != NULL) {
+        p->cb(fix, NMEA_SENTENCE_RMC, p->cb_arg);
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_handle_vtg
+* 说    明: 处理 xxVTG 语句：真航向与对地速度（km/h）
+* 参    数: p：解析器
+* 返 回 值: 无
+************************************************************************/
+static void nmea_handle_vtg(nmea_parser_t *p)
+{
+    nmea_fix_t *fix = &p->fix;
+
+    if (p->field_count < 9) {
+        return;
+    }
+    // 第 9 字段为模式指示，'N' 表示数据无效
+    if (*nmea_field(p, 9) == 'N' || *nmea_field(p, 7) == '\0') {
+        return;
+    }
+    fix->course = (float)nmea_parse_double(nmea_field(p, 1));
+    fix->speed_kmh = (float)nmea_parse_double(nmea_field(p, 7));
+
+    if (p->cb != NULL) {
+        p->cb(fix, NMEA_SENTENCE_VTG, p->cb_arg);
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_handle_gsa
+* 说    明: 处理 xxGSA 语句：定位模式与 PDOP/HDOP/VDOP
+* 参    数: p：解析器
+* 返 回 值: 无
+************************************************************************/
+static void nmea_handle_gsa(nmea_parser_t *p)
+{
+    nmea_fix_t *fix = &p->fix;
+
+    if (p->field_count < 18) {
+        return;
+    }
+    fix->fix_mode = (uint8_t)nmea_parse_uint(nmea_field(p, 2));
+    fix->pdop = (float)nmea_parse_double(nmea_field(p, 15));
+    fix->hdop = (float)nmea_parse_double(nmea_field(p, 16));
+    fix->vdop = (float)nmea_parse_double(nmea_field(p, 17));
+
+    if (p->cb != NULL) {
+        p->cb(fix, NMEA_SENTENCE_GSA, p->cb_arg);
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_gsv_system
+* 说    明: 根据发送者前缀确定 GSV 累加槽位
+* 参    数: addr：地址字段，如 "GPGSV"
+* 返 回 值: 槽位下标，未知系统返回 -1
+************************************************************************/
+static int nmea_gsv_system(const char *addr)
+{
+    if (addr[0] == 'G' && addr[1] == 'P') {
+        return 0;
+    }
+    if (addr[0] == 'G' && addr[1] == 'L') {
+        return 1;
+    }
+    if (addr[0] == 'G' && addr[1] == 'A') {
+        return 2;
+    }
+    if ((addr[0] == 'B' && addr[1] == 'D') || (addr[0] == 'G' && addr[1] == 'B')) {
+        return 3;
+    }
+    return -1;
+}
+
+/***********************************************************************
+* 函数名称: nmea_handle_gsv
+* 说    明: 处理 xxGSV 语句：各系统一个周期由多条语句组成，
+*           最后一条到达时汇总所有系统的可见卫星数与载噪比
+* 参    数: p：解析器
+* 返 回 值: 无
+************************************************************************/
+static void nmea_handle_gsv(nmea_parser_t *p)
+{
+    int sys = nmea_gsv_system(nmea_field(p, 0));
+    nmea_gsv_acc_t *acc;
+    uint32_t total;
+    uint32_t number;
+
+    if (sys < 0 || p->field_count < 4) {
+        return;
+    }
+    acc = &p->gsv[sys];
+    total = nmea_parse_uint(nmea_field(p, 1));
+    number = nmea_parse_uint(nmea_field(p, 2));
+    if (number == 1) {
+        memset(acc, 0, sizeof(*acc));
+    }
+    acc->in_view = (uint8_t)nmea_parse_uint(nmea_field(p, 3));
+
+    // 每颗卫星占 4 个字段：PRN、仰角、方位角、SNR；SNR 为空表示未跟踪
+    for (int i = 4; i + 3 < p->field_count && i < 20; i += 4) {
+        const char *snr_field = nmea_field(p, i + 3);
+        if (*snr_field != '\0') {
+            uint8_t snr = (uint8_t)nmea_parse_uint(snr_field);
+            acc->snr_sum += snr;
+            acc->snr_count++;
+            if (snr > acc->snr_max) {
+                acc->snr_max = snr;
+            }
+        }
+    }
+
+    if (number != total) {
+        return;
+    }
+
+    uint32_t in_view = 0;
+    uint32_t snr_sum = 0;
+    uint32_t snr_count = 0;
+    uint8_t snr_max = 0;
+    for (int i = 0; i < NMEA_GSV_SYSTEMS; i++) {
+        in_view += p->gsv[i].in_view;
+        snr_sum += p->gsv[i].snr_sum;
+        snr_count += p->gsv[i].snr_count;
+        if (p->gsv[i].snr_max > snr_max) {
+            snr_max = p->gsv[i].snr_max;
+        }
+    }
+    p->fix.sats_in_view = (uint8_t)(in_view > 255 ? 255 : in_view);
+    p->fix.snr_max = snr_max;
+    p->fix.snr_avg = (uint8_t)(snr_count ? snr_sum / snr_count : 0);
+
+    if (p->cb != NULL) {
+        p->cb(&p->fix, NMEA_SENTENCE_GSV, p->cb_arg);
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_dispatch
+* 说    明: 一条语句接收完成后按语句类型分发，忽略发送者前缀（GP/GN/BD...）
+* 参    数: p：解析器
+* 返 回 值: 无
+************************************************************************/
+static void nmea_dispatch(nmea_parser_t *p)
+{
+    const char *addr = nmea_field(p, 0);
+    size_t addr_len = strlen(addr);
+
+    // 缺少 *hh 或校验不一致的语句一律丢弃，避免错误坐标上报到云端
+    if (p->state != NMEA_STATE_CHECKSUM || p->rx_digits != 2 || p->rx_checksum != p->checksum) {
+        p->checksum_errors++;
+        return;
+    }
+    p->sentences++;
+    if (addr_len != 5) {
+        return;
+    }
+    if (strcmp(addr + 2, "GGA") == 0) {
+        nmea_handle_gga(p);
+    } else if (strcmp(addr + 2, "RMC") == 0) {
+        nmea_handle_rmc(p);
+    } else if (strcmp(addr + 2, "VTG") == 0) {
+        nmea_handle_vtg(p);
+    } else if (strcmp(addr + 2, "GSA") == 0) {
+        nmea_handle_gsa(p);
+    } else if (strcmp(addr + 2, "GSV") == 0) {
+        nmea_handle_gsv(p);
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_parser_init
+* 说    明: 初始化解析器
+* 参    数: p：解析器
+*           cb：每解析出一条已识别语句时的回调，可为 NULL
+*           arg：回调参数
+* 返 回 值: 无
+************************************************************************/
+void nmea_parser_init(nmea_parser_t *p, nmea_fix_cb_t cb, void *arg)
+{
+    memset(p, 0, sizeof(*p));
+    p->cb = cb;
+    p->cb_arg = arg;
+}
+
+/***********************************************************************
+* 函数名称: nmea_parser_feed
+* 说    明: 逐字节喂入串口数据，语句可以跨多次调用拆分到达
+*           接收时即把 ',' 替换为 '\0' 并记录字段偏移、累计校验，语句结束时校验并分发
+* 参    数: p：解析器
+*           data：本次收到的数据
+*           len：数据长度
+* 返 回 值: 无
+************************************************************************/
+void nmea_parser_feed(nmea_parser_t *p, const uint8_t *data, int len)
+{
+    for (int i = 0; i < len; i++) {
+        char c = (char)data[i];
+
+        if (c == '$') {
+            p->state = NMEA_STATE_BODY;
+            p->len = 0;
+            p->field_count = 1;
+            p->field[0] = 0;
+            p->checksum = 0;
+            p->rx_checksum = 0;
+            p->rx_digits = 0;
+            continue;
+        }
+        if (p->state == NMEA_STATE_IDLE) {
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            p->buf[p->len] = '\0';
+            nmea_dispatch(p);
+            p->state = NMEA_STATE_IDLE;
+            continue;
+        }
+        if (p->len >= NMEA_MAX_SENTENCE) {
+            p->overflows++;
+            p->state = NMEA_STATE_IDLE;
+            continue;
+        }
+        if (p->state == NMEA_STATE_CHECKSUM) {
+            int v = nmea_hex(c);
+            if (v < 0 || p->rx_digits >= 2) {
+                p->rx_digits = 0xFF;
+            } else {
+                p->rx_checksum = (uint8_t)((p->rx_checksum << 4) | v);
+                p->rx_digits++;
+            }
+            continue;
+        }
+
+        if (c != '*') {
+            p->checksum ^= (uint8_t)c;
+        }
+        if (c == ',' || c == '*') {
+            p->buf[p->len++] = '\0';
+            if (c == '*') {
+                p->state = NMEA_STATE_CHECKSUM;
+            } else if (p->field_count < NMEA_MAX_FIELDS) {
+                p->field[p->field_count++] = p->len;
+            }
+        } else {
+            p->buf[p->len++] = c;
+        }
+    }
+}
+
+/***********************************************************************
+* 函数名称: nmea_format_e7
+* 说    明: 把 1e-7 度格式化为十进制度字符串（如 -23.1234567），只用整数运算
+* 参    数: value：1e-7 度
+*           buf：输出缓存
+*           len：缓存大小
+* 返 回 值: snprintf 的返回值
+************************************************************************/
+int nmea_format_e7(int32_t value, char *buf, int len)
+{
+    uint32_t mag = (value < 0) ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+
+    return snprintf(buf, (size_t)len, "%s%u.%07u", (value < 0) ? "-" : "",
+                    (unsigned int)(mag / 10000000U), (unsigned int)(mag % 10000000U));
+}
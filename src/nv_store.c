@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <string.h>
+#include "hi_flash.h"
+#include "hi_partition_table.h"
+#include "cmsis_os2.h"
+#include "nv_store.h"
+
+#define NV_SECTOR_MAGIC     0x3153564EU     // "NVS1"
+#define NV_RECORD_MAGIC     0xA5
+#define NV_SECTOR_HDR_SIZE  8
+#define NV_RECORD_HDR_SIZE  4
+#define NV_ALIGN4(n)        (((n) + 3U) & ~3U)
+
+/*
+ * 日志式存储：两个扇区轮流使用，有效扇区头部写有序号，记录依次追加在其后，
+ * 同一 key 以最后一条为准。扇区写满时把每个 key 的最新记录搬到另一个扇区，
+ * 新扇区的头部最后写入，搬移中途掉电时旧扇区仍然有效。
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;
+} nv_sector_hdr_t;
+
+typedef struct
+{
+    uint8_t magic;
+    uint8_t key;
+    uint8_t len;
+    uint8_t crc;
+} nv_record_hdr_t;
+
+static uint32_t g_active_base;
+static uint32_t g_seq;
+static uint32_t g_write_off;
+static uint16_t g_index[NV_KEY_MAX];    // 各 key 最新记录在扇区内的偏移，0 表示无
+static uint8_t g_record_buf[NV_RECORD_HDR_SIZE + NV_ALIGN4(NV_STORE_MAX_LEN)];
+static osMutexId_t g_nv_mutex = NULL;
+
+/***********************************************************************
+* 函数名称: nv_crc8
+* 说    明: CRC-8（多项式 0x07）
+* 参    数: crc：初值
+*           data：数据
+*           len：长度
+* 返 回 值: 校验值
+************************************************************************/
+static uint8_t nv_crc8(uint8_t crc, const uint8_t *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/***********************************************************************
+* 函数名称: nv_record_crc
+* 说    明: 计算记录校验，覆盖 key、len 与数据
+* 参    数: hdr：记录头
+*           data：数据
+* 返 回 值: 校验值
+************************************************************************/
+static uint8_t nv_record_crc(const nv_record_hdr_t *hdr, const uint8_t *data)
+{
+    uint8_t crc = nv_crc8(0xFF, &hdr->key, 2);
+    return nv_crc8(crc, data, hdr->len);
+}
+
+/***********************************************************************
+* 函数名称: nv_scan
+* 说    明: 扫描扇区，建立各 key 的最新记录索引并确定追加位置；
+*           遇到损坏的记录头时把扇区视为已满，下次写入触发搬移
+* 参    数: base：扇区起始地址
+* 返 回 值: 无
+************************************************************************/
+static void nv_scan(uint32_t base)
+{
+    uint32_t off = NV_SECTOR_HDR_SIZE;
+    nv_record_hdr_t hdr;
+
+    memset(g_index, 0, sizeof(g_index));
+    while (off + NV_RECORD_HDR_SIZE <= NV_STORE_SECTOR_SIZE) {
+        if (hi_flash_read(base + off, sizeof(hdr), (uint8_t *)&hdr) != 0 || hdr.magic == 0xFF) {
+            break;
+        }
+        uint32_t size = NV_RECORD_HDR_SIZE + NV_ALIGN4(hdr.len);
+        if (hdr.magic != NV_RECORD_MAGIC || hdr.len > NV_STORE_MAX_LEN || off + size > NV_STORE_SECTOR_SIZE) {
+            off = NV_STORE_SECTOR_SIZE;
+            break;
+        }
+        // 校验失败的记录（写入中途掉电）跳过，保留该 key 之前的记录
+        if (hi_flash_read(base + off + NV_RECORD_HDR_SIZE, hdr.len, g_record_buf) == 0 &&
+            hdr.key < NV_KEY_MAX && nv_record_crc(&hdr, g_record_buf) == hdr.crc) {
+            g_index[hdr.key] = (uint16_t)off;
+        }
+        off += size;
+    }
+    g_write_off = off;
+}
+
+/***********************************************************************
+* 函数名称: nv_format
+* 说    明: 擦除扇区并写入扇区头，作为空的有效扇区
+* 参    数: base：扇区起始地址
+*           seq：扇区序号
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+static int nv_format(uint32_t base, uint32_t seq)
+{
+    nv_sector_hdr_t hdr = { NV_SECTOR_MAGIC, seq };
+
+    if (hi_flash_erase(base, NV_STORE_SECTOR_SIZE) != 0 ||
+        hi_flash_write(base, sizeof(hdr), (const uint8_t *)&hdr, 0) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: nv_compact
+* 说    明: 把各 key 的最新记录搬到另一个扇区，成功后切换为有效扇区
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+static int nv_compact(void)
+{
+    uint32_t dst = (g_active_base == NV_STORE_FLASH_BASE) ?
+                   NV_STORE_FLASH_BASE + NV_STORE_SECTOR_SIZE : NV_STORE_FLASH_BASE;
+    uint32_t off = NV_SECTOR_HDR_SIZE;
+    uint16_t index[NV_KEY_MAX] = { 0 };
+    nv_sector_hdr_t hdr = { NV_SECTOR_MAGIC, g_seq + 1 };
+
+    if (hi_flash_erase(dst, NV_STORE_SECTOR_SIZE) != 0) {
+        return -1;
+    }
+    for (int key = 0; key < NV_KEY_MAX; key++) {
+        if (g_index[key] == 0) {
+            continue;
+        }
+        nv_record_hdr_t *rec = (nv_record_hdr_t *)g_record_buf;
+        hi_flash_read(g_active_base + g_index[key], NV_RECORD_HDR_SIZE, g_record_buf);
+        uint32_t size = NV_RECORD_HDR_SIZE + NV_ALIGN4(rec->len);
+        hi_flash_read(g_active_base + g_index[key], size, g_record_buf);
+        if (hi_flash_write(dst + off, size, g_record_buf, 0) != 0) {
+            return -1;
+        }
+        index[key] = (uint16_t)off;
+        off += size;
+    }
+    if (hi_flash_write(dst, sizeof(hdr), (const uint8_t *)&hdr, 0) != 0) {
+        return -1;
+    }
+    g_active_base = dst;
+    g_seq = hdr.seq;
+    g_write_off = off;
+    memcpy(g_index, index, sizeof(g_index));
+    printf("[nv_store] compacted into sector 0x%x, seq %u\n", (unsigned)dst, (unsigned)g_seq);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: nv_check_partition
+* 说    明: 对照 SDK 分区表检查两个扇区只落在用户保留区内，
+*           与引导、NV、内核、文件系统、崩溃信息等分区重叠时拒绝使用
+* 参    数: 无
+* 返 回 值: 0 可用，-1 重叠或读不到分区表
+************************************************************************/
+static int nv_check_partition(void)
+{
+    hi_flash_partition_table *table = hi_get_partition_table();
+    uint32_t start = NV_STORE_FLASH_BASE;
+    uint32_t end = NV_STORE_FLASH_BASE + 2 * NV_STORE_SECTOR_SIZE;
+
+    if (table == NULL) {
+        printf("[nv_store] Failed to get partition table!\n");
+        return -1;
+    }
+    for (int i = 0; i < HI_FLASH_PARTITON_MAX; i++) {
+        uint32_t addr = table->table[i].addr;
+        uint32_t size = table->table[i].size;
+        if (i == HI_FLASH_PARTITON_USR_RESERVE || size == 0) {
+            continue;
+        }
+        if (start < addr + size && addr < end) {
+            printf("[nv_store] 0x%x-0x%x overlaps partition %d (0x%x-0x%x)!\n",
+                   (unsigned)start, (unsigned)end, i, (unsigned)addr, (unsigned)(addr + size));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: nv_store_init
+* 说    明: 选出序号较新的有效扇区并建立索引，两个扇区都无效时格式化第一个；
+*           可重复调用
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int nv_store_init(void)
+{
+    nv_sector_hdr_t hdr[2];
+    int valid[2];
+
+    if (g_nv_mutex != NULL) {
+        return 0;
+    }
+    if (nv_check_partition() != 0) {
+        return -1;
+    }
+    g_nv_mutex = osMutexNew(NULL);
+    if (g_nv_mutex == NULL) {
+        printf("[nv_store] Failed to create mutex!\n");
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        valid[i] = hi_flash_read(NV_STORE_FLASH_BASE + i * NV_STORE_SECTOR_SIZE, sizeof(hdr[i]),
+                                 (uint8_t *)&hdr[i]) == 0 && hdr[i].magic == NV_SECTOR_MAGIC;
+    }
+
+    if (valid[0] && valid[1]) {
+        int use = ((int32_t)(hdr[1].seq - hdr[0].seq) > 0) ? 1 : 0;
+        g_active_base = NV_STORE_FLASH_BASE + use * NV_STORE_SECTOR_SIZE;
+        g_seq = hdr[use].seq;
+    } else if (valid[0] || valid[1]) {
+        int use = valid[1] ? 1 : 0;
+        g_active_base = NV_STORE_FLASH_BASE + use * NV_STORE_SECTOR_SIZE;
+        g_seq = hdr[use].seq;
+    } else {
+        g_active_base = NV_STORE_FLASH_BASE;
+        g_seq = 1;
+        if (nv_format(g_active_base, g_seq) != 0) {
+            printf("[nv_store] Failed to format flash!\n");
+            return -1;
+        }
+    }
+    nv_scan(g_active_base);
+    printf("[nv_store] sector 0x%x seq %u, %u bytes used\n",
+           (unsigned)g_active_base, (unsigned)g_seq, (unsigned)g_write_off);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: nv_store_read
+* 说    明: 读取某个 key 的最新值
+* 参    数: key：数据项
+*           buf：输出缓存
+*           len：缓存大小，记录更长时只读取前 len 字节
+* 返 回 值: 记录的实际长度，不存在或失败返回 -1
+************************************************************************/
+int nv_store_read(nv_key_t key, void *buf, uint16_t len)
+{
+    nv_record_hdr_t hdr;
+    int ret = -1;
+
+    if (g_nv_mutex == NULL || key >= NV_KEY_MAX) {
+        return -1;
+    }
+    osMutexAcquire(g_nv_mutex, osWaitForever);
+    if (g_index[key] != 0 &&
+        hi_flash_read(g_active_base + g_index[key], sizeof(hdr), (uint8_t *)&hdr) == 0) {
+        uint16_t n = (len < hdr.len) ? len : hdr.len;
+        if (hi_flash_read(g_active_base + g_index[key] + NV_RECORD_HDR_SIZE, n, buf) == 0) {
+            ret = hdr.len;
+        }
+    }
+    osMutexRelease(g_nv_mutex);
+    return ret;
+}
+
+/***********************************************************************
+* 函数名称: nv_store_write
+* 说    明: 追加写入某个 key 的新值，与当前值相同时不写 flash；
+*           扇区剩余空间不足时先搬移到另一个扇区
+* 参    数: key：数据项
+*           data：数据
+*           len：长度，不超过 NV_STORE_MAX_LEN
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int nv_store_write(nv_key_t key, const void *data, uint16_t len)
+{
+    nv_record_hdr_t *rec = (nv_record_hdr_t *)g_record_buf;
+    uint32_t size = NV_RECORD_HDR_SIZE + NV_ALIGN4(len);
+    int ret = -1;
+
+    if (g_nv_mutex == NULL || key >= NV_KEY_MAX || len > NV_STORE_MAX_LEN) {
+        return -1;
+    }
+    osMutexAcquire(g_nv_mutex, osWaitForever);
+    if (g_index[key] != 0) {
+        hi_flash_read(g_active_base + g_index[key], NV_RECORD_HDR_SIZE + len, g_record_buf);
+        if (rec->len == len && memcmp(g_record_buf + NV_RECORD_HDR_SIZE, data, len) == 0) {
+            osMutexRelease(g_nv_mutex);
+            return 0;
+        }
+    }
+    if (g_write_off + size > NV_STORE_SECTOR_SIZE && nv_compact() != 0) {
+        printf("[nv_store] compaction failed!\n");
+        osMutexRelease(g_nv_mutex);
+        return -1;
+    }
+    if (g_write_off + size <= NV_STORE_SECTOR_SIZE) {
+        memset(g_record_buf, 0xFF, size);
+        rec->magic = NV_RECORD_MAGIC;
+        rec->key = (uint8_t)key;
+        rec->len = (uint8_t)len;
+        memcpy(g_record_buf + NV_RECORD_HDR_SIZE, data, len);
+        rec->crc = nv_record_crc(rec, g_record_buf + NV_RECORD_HDR_SIZE);
+        if (hi_flash_write(g_active_base + g_write_off, size, g_record_buf, 0) == 0) {
+            g_index[key] = (uint16_t)g_write_off;
+            ret = 0;
+        }
+        g_write_off += size;
+    }
+    osMutexRelease(g_nv_mutex);
+    return ret;
+}
@@ -57,6 +57,8 @@ typedef struct
 
 static oc_mqtt_profile_cb_t s_oc_mqtt_profile_cb;
 
+#define CN_OC_MQTT_TOPIC_MAXLEN     160     ///< longest downlink topic we route, request_id included
+
 
 static char init_ok = FALSE;
 static MQTTClient mq_client;
@@ -67,8 +69,84 @@ struct oc_device
 
     void(*cmd_rsp_cb)(uint8_t *recv_data, size_t recv_size, uint8_t **resp_data, size_t *resp_size);
 
+    void(*conn_cb)(int connected);
+
+    int connected;
+
 } oc_mqtt;
 
+///< report a connection state change to the application, only when it really changed
+static void oc_mqtt_conn_notify(int connected)
+{
+    connected = (connected != 0);
+    if (connected == oc_mqtt.connected)
+    {
+        return;
+    }
+    oc_mqtt.connected = connected;
+    if (oc_mqtt.conn_cb != NULL)
+    {
+        oc_mqtt.conn_cb(connected);
+    }
+}
+
+///< route a downlink by its topic to the profile receive call back:
+///< $oc/devices/{device_id}/sys/{commands|properties/set|properties/get|messages/down|events/down}[/request_id={id}]
+///< the topic and payload are only valid during the call back
+static int oc_mqtt_profile_route(MessageData *msg_data)
+{
+    oc_mqtt_profile_msgrcv_t rcv;
+    char topic[CN_OC_MQTT_TOPIC_MAXLEN];
+    char *sys;
+    char *request_id;
+    int len = msg_data->topicName->lenstring.len;
+
+    if ((NULL == s_oc_mqtt_profile_cb.rcvfunc) || (len <= 0) || (len >= (int)sizeof(topic)))
+    {
+        return -1;
+    }
+    memcpy(topic, msg_data->topicName->lenstring.data, len);
+    topic[len] = '\0';
+
+    sys = strstr(topic, "/sys/");
+    if (NULL == sys)
+    {
+        return -1;
+    }
+    sys += strlen("/sys/");
+    if (0 == strncmp(sys, "commands", strlen("commands")))
+    {
+        rcv.type = EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_COMMANDS;
+    }
+    else if (0 == strncmp(sys, "properties/set", strlen("properties/set")))
+    {
+        rcv.type = EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_PROPERTYSET;
+    }
+    else if (0 == strncmp(sys, "properties/get", strlen("properties/get")))
+    {
+        rcv.type = EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_PROPERTYGET;
+    }
+    else if (0 == strncmp(sys, "messages/down", strlen("messages/down")))
+    {
+        rcv.type = EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_MSGDOWN;
+    }
+    else if (0 == strncmp(sys, "events/down", strlen("events/down")))
+    {
+        rcv.type = EN_OC_MQTT_PROFILE_MSG_TYPE_DOWN_EVENT;
+    }
+    else
+    {
+        return -1;
+    }
+
+    request_id = strstr(sys, "request_id=");
+    rcv.request_id = (NULL != request_id) ? request_id + strlen("request_id=") : NULL;
+    rcv.msg = msg_data->message->payload;
+    rcv.msg_len = (int)msg_data->message->payloadlen;
+    (void)s_oc_mqtt_profile_cb.rcvfunc(&rcv);
+    return 0;
+}
+
  void mqtt_callback(MessageData *msg_data)
 {
     size_t res_len = 0;
@@ -77,6 +155,11 @@ struct oc_device
 
     LOS_ASSERT(msg_data);
 
+    if (0 == oc_mqtt_profile_route(msg_data))
+    {
+        return;
+    }
+
     //LOG_D("topic %.*s receive a message", msg_data->topicName->lenstring.len, msg_data->topicName->lenstring.data);
 
     //LOG_D("message length is %d", msg_data->message->payloadlen);
@@ -139,6 +222,8 @@ static int oc_mqtt_entry(void)
 
 	rc = MQTTConnect(&mq_client, &data);
 
+    oc_mqtt_conn_notify(rc == 0);
+
     return rc;
     
 }
@@ -151,6 +236,8 @@ void device_info_init(char *client_id, char * username, char *password)
     strncpy(oc_info.username,     username, strlen(username));
     strncpy(oc_info.password,  password, strlen(password));
 
+    ///< the device id is the user name, used when the profile apis get a NULL device id
+    s_oc_mqtt_profile_cb.device_id = oc_info.username;
 }
 
 /**
@@ -203,6 +290,79 @@ void oc_set_cmd_rsp_cb(void (*cmd_rsp_cb)(uint8_t *recv_data, uint32_t recv_size
 
 }
 
+/**
+ * set the profile receive call back function. When set, downlinks are routed by
+ * topic (commands, properties set/get, messages, events) with the request_id taken
+ * from the topic, instead of going to the command responses call back
+ *
+ * @param   rcvfunc  profile receive call back function, NULL to disable routing
+ */
+void oc_set_profile_rcv_cb(fn_oc_mqtt_profile_rcvdeal rcvfunc)
+{
+    s_oc_mqtt_profile_cb.rcvfunc = rcvfunc;
+}
+
+/**
+ * set the connection state call back function, called on every change of the
+ * broker connection (connect result, lost connection found by publish or poll)
+ *
+ * @param   conn_cb  connection state call back function, connected is 1 or 0
+ */
+void oc_set_conn_cb(void (*conn_cb)(int connected))
+{
+    oc_mqtt.conn_cb = conn_cb;
+}
+
+/**
+ * get the broker connection state, and report it through the connection
+ * call back if it changed (e.g. the keepalive found the link dead)
+ *
+ * @return  1 : connected
+ *          0 : not connected
+ */
+int oc_mqtt_is_connected(void)
+{
+    oc_mqtt_conn_notify(MQTTIsConnected(&mq_client));
+    return oc_mqtt.connected;
+}
+
+/**
+ * reconnect to the broker after the connection was lost: close the old socket,
+ * open a new one and send CONNECT again with the device info given at init.
+ * the platform delivers the $oc/devices/{device_id}/sys/ downlinks without a
+ * subscription, so there is nothing to subscribe again. blocks for the TCP
+ * connect and the CONNACK (command timeout of the client), the caller should
+ * limit how often it retries
+ *
+ * @return  0 : connected
+ *         -1 : client never initialized (no memory at init)
+ *         other : connect failed
+ */
+int oc_mqtt_reconnect(void)
+{
+    int rc;
+
+    if ((NULL == oc_mqtt_buf) || (NULL == oc_mqtt_readbuf))
+    {
+        return -1;
+    }
+    if (MQTTIsConnected(&mq_client))
+    {
+        oc_mqtt_conn_notify(1);
+        return 0;
+    }
+
+    NetworkDisconnect(&n);
+    rc = NetworkConnect(&n, OC_SERVER_IP, OC_SERVER_PORT);
+    if (0 == rc)
+    {
+        rc = MQTTConnect(&mq_client, &data);
+    }
+    oc_mqtt_conn_notify(rc == 0);
+
+    return rc;
+}
+
 
 /**
  * mqtt publish msg to topic
@@ -228,6 +388,7 @@ void oc_set_cmd_rsp_cb(void (*cmd_rsp_cb)(uint8_t *recv_data, uint32_t recv_size
 
     if (MQTTPublish(&mq_client, topic, &message) < 0)
     {
+        oc_mqtt_conn_notify(MQTTIsConnected(&mq_client));
         return -1;
     }
 
@@ -40,7 +40,19 @@
 #include <oc_mqtt.h>
 #include <oc_mqtt_profile_package.h>
 
+#include <stdio.h>
+#include <stdint.h>
 #include <cJSON.h>
+#include <nmea_parser.h>
+
+///< format a 1e-7 fixed point value as a raw json number, same text as the alarm and aiding records
+static cJSON *profile_fmt_e7(int32_t value)
+{
+    char buf[16];
+
+    (void) nmea_format_e7(value, buf, sizeof(buf));
+    return cJSON_CreateRaw(buf);
+}
 
 ///< format the report data to json string mode
 static cJSON  *profile_fmtvalue(oc_mqtt_profile_kv_t  *kv)
@@ -60,6 +72,9 @@ static cJSON  *profile_fmtvalue(oc_mqtt_profile_kv_t  *kv)
         case EN_OC_MQTT_PROFILE_VALUE_STRING:
             ret = cJSON_CreateString((const char *)kv->value);
             break;
+        case EN_OC_MQTT_PROFILE_VALUE_E7:
+            ret = profile_fmt_e7(*(int32_t *)kv->value);
+            break;
         default:
             break;
     }
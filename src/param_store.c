@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include "nv_store.h"
+#include "param_store.h"
+
+#define PARAM_STORE_SCHEMA      1       // 记录格式版本，格式不兼容时修改，旧记录将被忽略
+
+typedef union
+{
+    int32_t i;
+    float f;
+} param_value_t;
+
+/***********************************************************************
+* 结构体名称: param_def_t
+* 说    明: 参数定义：平台属性名、类型、取值范围与缺省值
+************************************************************************/
+typedef struct
+{
+    const char *name;
+    param_type_t type;
+    float min;
+    float max;
+    param_value_t def;
+} param_def_t;
+
+/***********************************************************************
+* 结构体名称: param_record_t
+* 说    明: flash 中保存的参数集。count 为保存时的参数个数，
+*           新固件增加的参数在旧记录中不存在时取缺省值
+************************************************************************/
+typedef struct
+{
+    uint16_t schema;
+    uint8_t count;
+    uint8_t reserved;
+    uint32_t version;
+    param_value_t values[PARAM_MAX];
+} param_record_t;
+
+static const param_def_t g_param_defs[PARAM_MAX] =
+{
+    [PARAM_COOLING_TEMP_ON]   = { "Cooling_temp_on", PARAM_TYPE_FLOAT, 25.0f, 40.0f, { .f = 29.0f } },
+    [PARAM_COOLING_TEMP_HYST] = { "Cooling_temp_hyst", PARAM_TYPE_FLOAT, 0.1f, 2.0f, { .f = 0.3f } },
+    [PARAM_COOLING_HR_ON]     = { "Cooling_hr_on", PARAM_TYPE_INT, 60, 200, { .i = 99 } },
+    [PARAM_HRV_BASELINE_HR]   = { "Hrv_baseline_hr", PARAM_TYPE_INT, 40, 120, { .i = 70 } },
+    [PARAM_REPORT_PERIOD]     = { "Report_period", PARAM_TYPE_INT, 1, 3600, { .i = 5 } },
+};
+
+static param_record_t g_params;     // 当前生效的参数，各任务直接读取 32 位取值
+static param_record_t g_staged;     // 平台修改的暂存区，全部校验通过后一次提交
+static param_change_cb_t g_change_cb = NULL;
+
+/***********************************************************************
+* 函数名称: param_store_valid
+* 说    明: 检查取值是否在参数范围内
+* 参    数: id：参数
+*           value：取值
+* 返 回 值: 1 有效，0 无效
+************************************************************************/
+static int param_store_valid(param_id_t id, param_value_t value)
+{
+    const param_def_t *def = &g_param_defs[id];
+    float v = (def->type == PARAM_TYPE_INT) ? (float)value.i : value.f;
+
+    return v >= def->min && v <= def->max;      // NaN 不满足比较，同样无效
+}
+
+/***********************************************************************
+* 函数名称: param_store_init
+* 说    明: 加载 flash 中保存的参数集，无记录、格式不符或取值越界的参数使用缺省值
+* 参    数: cb：参数变化回调，可为 NULL
+* 返 回 值: 0 已加载保存的参数，-1 使用缺省参数
+************************************************************************/
+int param_store_init(param_change_cb_t cb)
+{
+    param_record_t rec;
+    int len;
+    int loaded = 0;
+
+    g_change_cb = cb;
+    memset(&g_params, 0, sizeof(g_params));
+    g_params.schema = PARAM_STORE_SCHEMA;
+    g_params.count = PARAM_MAX;
+    for (int i = 0; i < PARAM_MAX; i++) {
+        g_params.values[i] = g_param_defs[i].def;
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    len = nv_store_read(NV_KEY_PARAMS, &rec, sizeof(rec));
+    if (len >= (int)offsetof(param_record_t, values) && rec.schema == PARAM_STORE_SCHEMA) {
+        int count = (len - (int)offsetof(param_record_t, values)) / (int)sizeof(param_value_t);
+        if (count > rec.count) {
+            count = rec.count;
+        }
+        if (count > PARAM_MAX) {
+            count = PARAM_MAX;
+        }
+        for (int i = 0; i < count; i++) {
+            if (param_store_valid((param_id_t)i, rec.values[i])) {
+                g_params.values[i] = rec.values[i];
+            }
+        }
+        g_params.version = rec.version;
+        loaded = 1;
+    }
+    printf("[param] version %u %s\n", (unsigned)g_params.version, loaded ? "loaded" : "defaults");
+    return loaded ? 0 : -1;
+}
+
+/***********************************************************************
+* 函数名称: param_get_int
+* 说    明: 读取整数参数，可在任意任务中调用
+* 参    数: id：参数
+* 返 回 值: 取值
+************************************************************************/
+int32_t param_get_int(param_id_t id)
+{
+    return g_params.values[id].i;
+}
+
+/***********************************************************************
+* 函数名称: param_get_float
+* 说    明: 读取浮点参数，可在任意任务中调用
+* 参    数: id：参数
+* 返 回 值: 取值
+************************************************************************/
+float param_get_float(param_id_t id)
+{
+    return g_params.values[id].f;
+}
+
+/***********************************************************************
+* 函数名称: param_store_version
+* 说    明: 获取参数集版本号，每次提交修改加一
+* 参    数: 无
+* 返 回 值: 版本号
+************************************************************************/
+uint32_t param_store_version(void)
+{
+    return g_params.version;
+}
+
+/***********************************************************************
+* 函数名称: param_store_name
+* 说    明: 获取参数的平台属性名
+* 参    数: id：参数
+* 返 回 值: 属性名
+************************************************************************/
+const char *param_store_name(param_id_t id)
+{
+    return g_param_defs[id].name;
+}
+
+/***********************************************************************
+* 函数名称: param_store_type
+* 说    明: 获取参数类型
+* 参    数: id：参数
+* 返 回 值: 类型
+************************************************************************/
+param_type_t param_store_type(param_id_t id)
+{
+    return g_param_defs[id].type;
+}
+
+/***********************************************************************
+* 函数名称: param_store_begin
+* 说    明: 开始一次修改，以当前参数初始化暂存区。修改只在主任务中进行
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void param_store_begin(void)
+{
+    g_staged = g_params;
+}
+
+/***********************************************************************
+* 函数名称: param_store_stage
+* 说    明: 按属性名（不区分大小写）把新取值写入暂存区
+* 参    数: name：属性名
+*           value：取值，整数参数须为整数
+* 返 回 值: 0 成功，-1 未知参数，-2 类型不符或超出范围
+************************************************************************/
+int param_store_stage(const char *name, double value)
+{
+    for (int i = 0; i < PARAM_MAX; i++) {
+        param_value_t v;
+        if (0 != strcasecmp(name, g_param_defs[i].name)) {
+            continue;
+        }
+        if (!(value >= g_param_defs[i].min && value <= g_param_defs[i].max)) {
+            return -2;
+        }
+        if (g_param_defs[i].type == PARAM_TYPE_INT) {
+            v.i = (int32_t)value;
+            if (value != (double)v.i) {
+                return -2;
+            }
+        } else {
+            v.f = (float)value;
+        }
+        g_staged.values[i] = v;
+        return 0;
+    }
+    return -1;
+}
+
+/***********************************************************************
+* 函数名称: param_store_commit
+* 说    明: 提交暂存区：有变化时版本号加一，写入 flash 后替换生效参数并逐个回调
+* 参    数: 无
+* 返 回 值: 变化的参数个数，写 flash 失败返回 -1（参数不生效）
+************************************************************************/
+int param_store_commit(void)
+{
+    uint32_t changed = 0;
+    int count = 0;
+
+    for (int i = 0; i < PARAM_MAX; i++) {
+        if (g_staged.values[i].i != g_params.values[i].i) {
+            changed |= 1U << i;
+            count++;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    g_staged.version = g_params.version + 1;
+    if (0 != nv_store_write(NV_KEY_PARAMS, &g_staged, sizeof(g_staged))) {
+        printf("[param] failed to persist version %u\n", (unsigned)g_staged.version);
+        return -1;
+    }
+    for (int i = 0; i < PARAM_MAX; i++) {
+        g_params.values[i] = g_staged.values[i];
+    }
+    g_params.version = g_staged.version;
+    printf("[param] version %u, %d changed\n", (unsigned)g_params.version, count);
+    for (int i = 0; i < PARAM_MAX; i++) {
+        if ((changed & (1U << i)) && g_change_cb != NULL) {
+            g_change_cb((param_id_t)i);
+        }
+    }
+    return count;
+}
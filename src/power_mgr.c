@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <string.h>
+#include "hi_errno.h"
+#include "hi_time.h"
+#include "hi_lowpower.h"
+#include "hi_wifi_api.h"
+#include "sensor_sched.h"
+#include "power_mgr.h"
+
+/*
+ * 所有任务都阻塞时，空闲任务在进入睡眠前调用检查函数。这里取各任务与定时器最早的
+ * 唤醒时刻得出空闲窗口，选择能在窗口内回本的最深睡眠状态；系统节拍的挂起与补偿
+ * 由 SDK 的低功耗框架完成。检查函数在空闲上下文中执行，只读取各任务发布的
+ * 截止时刻与否决标志，不加锁、不阻塞
+ */
+static volatile uint32_t g_deadline[POWER_SRC_MAX];
+static volatile uint8_t g_deadline_set[POWER_SRC_MAX];
+static volatile uint8_t g_veto[POWER_VETO_MAX];
+static volatile int g_wifi_ps = 0;
+static power_state_t g_planned = POWER_STATE_ACTIVE;
+static uint32_t g_planned_wake_ms;
+static uint32_t g_sleep_start_ms;
+static uint32_t g_init_ms;
+static power_stats_t g_stats;
+
+/***********************************************************************
+* 函数名称: power_mgr_window
+* 说    明: 计算到最早唤醒时刻的空闲窗口
+* 参    数: now_ms：当前时刻
+* 返 回 值: 窗口（毫秒），已有到期的截止时刻时为 0
+************************************************************************/
+static uint32_t power_mgr_window(uint32_t now_ms)
+{
+    int32_t window = (int32_t)(sensor_sched_next_deadline() - now_ms);
+
+    for (int i = 0; i < POWER_SRC_MAX; i++) {
+        int32_t remain = (int32_t)(g_deadline[i] - now_ms);
+        if (g_deadline_set[i] && remain < window) {
+            window = remain;
+        }
+    }
+    return (window > 0) ? (uint32_t)window : 0;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_check
+* 说    明: 睡眠检查回调（空闲任务中执行）：窗口过短时不睡眠；Wi-Fi 省电模式下
+*           每个 DTIM 监听间隔都会唤醒芯片，窗口按该间隔截短；启用深睡眠时截短后
+*           仍足够长且没有否决条件则进入深睡眠，否则进入浅睡眠
+* 参    数: 无
+* 返 回 值: HI_TRUE 允许睡眠，HI_FALSE 不睡眠
+************************************************************************/
+static hi_u32 power_mgr_check(hi_void)
+{
+    uint32_t now_ms = hi_get_milli_seconds();
+    uint32_t window_ms = power_mgr_window(now_ms);
+    power_state_t state = POWER_STATE_LIGHT;
+
+    if (window_ms < POWER_MGR_LIGHT_MIN_MS) {
+        g_stats.short_idle++;
+        g_planned = POWER_STATE_ACTIVE;
+        return HI_FALSE;
+    }
+    if (g_wifi_ps && window_ms > POWER_MGR_DTIM_MS) {
+        window_ms = POWER_MGR_DTIM_MS;
+    }
+    if (POWER_MGR_DEEP_SLEEP && window_ms >= POWER_MGR_DEEP_MIN_MS) {
+        state = POWER_STATE_DEEP;
+        for (int i = 0; i < POWER_VETO_MAX; i++) {
+            if (g_veto[i]) {
+                g_stats.vetoes[i]++;
+                state = POWER_STATE_LIGHT;
+                break;
+            }
+        }
+    }
+    g_planned = state;
+    g_planned_wake_ms = now_ms + window_ms;
+    (void)hi_lpc_set_type((state == POWER_STATE_DEEP) ? HI_DEEP_SLEEP : HI_LIGHT_SLEEP);
+    return HI_TRUE;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_prepare
+* 说    明: 进入睡眠前由低功耗框架调用，记录进入时刻
+* 参    数: 无
+* 返 回 值: HI_ERR_SUCCESS
+************************************************************************/
+static hi_u32 power_mgr_prepare(hi_void)
+{
+    g_sleep_start_ms = hi_get_milli_seconds();
+    g_stats.entries[g_planned]++;
+    return HI_ERR_SUCCESS;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_resume
+* 说    明: 唤醒后由低功耗框架调用（节拍已补偿），累计驻留时间
+* 参    数: 无
+* 返 回 值: HI_ERR_SUCCESS
+************************************************************************/
+static hi_u32 power_mgr_resume(hi_void)
+{
+    uint32_t now_ms = hi_get_milli_seconds();
+
+    g_stats.residency_ms[g_planned] += now_ms - g_sleep_start_ms;
+    if ((int32_t)(g_planned_wake_ms - now_ms) > 0) {
+        g_stats.early_wakes++;
+    }
+    return HI_ERR_SUCCESS;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_init
+* 说    明: 注册睡眠检查与睡眠前后处理函数，允许空闲时睡眠。hi_lpc_init 已在 SDK 启动时调用
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败（保持不睡眠）
+************************************************************************/
+int power_mgr_init(void)
+{
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_init_ms = hi_get_milli_seconds();
+    if (hi_lpc_register_check_handler(power_mgr_check) != HI_ERR_SUCCESS ||
+        hi_lpc_register_hw_handler(power_mgr_prepare, power_mgr_resume) != HI_ERR_SUCCESS) {
+        printf("[power] Failed to register low power handlers!\n");
+        return -1;
+    }
+    (void)hi_lpc_set_type(HI_LIGHT_SLEEP);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_wifi_ps
+* 说    明: 开关 Wi-Fi 省电模式，需在连上 AP 后调用。开启后射频只在
+*           每 POWER_MGR_DTIM_MULTIPLE 个 DTIM 周期醒来接收 AP 缓存的帧，下行时延相应增加
+* 参    数: enable：1 开启，0 关闭
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int power_mgr_wifi_ps(int enable)
+{
+    if (hi_wifi_set_pm_switch(enable ? 1 : 0, POWER_MGR_DTIM_MULTIPLE) != 0) {
+        printf("[power] Failed to set wifi power save %d!\n", enable);
+        return -1;
+    }
+    g_wifi_ps = enable;
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_set_deadline
+* 说    明: 任务阻塞前发布下一次需要运行的时刻，可在任意任务或定时器回调中调用
+* 参    数: src：发布者
+*           deadline_ms：时刻（hi_get_milli_seconds 时基）
+* 返 回 值: 无
+************************************************************************/
+void power_mgr_set_deadline(power_src_t src, uint32_t deadline_ms)
+{
+    g_deadline[src] = deadline_ms;
+    g_deadline_set[src] = 1;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_veto
+* 说    明: 设置或清除深睡眠否决条件，可在中断中调用
+* 参    数: veto：否决条件
+*           on：1 禁止深睡眠，0 解除
+* 返 回 值: 无
+************************************************************************/
+void power_mgr_veto(power_veto_t veto, int on)
+{
+    g_veto[veto] = (uint8_t)(on != 0);
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_get_stats
+* 说    明: 获取功耗状态统计，ACTIVE 驻留时间为初始化以来的总时间减去睡眠时间
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void power_mgr_get_stats(power_stats_t *stats)
+{
+    uint32_t total_ms = hi_get_milli_seconds() - g_init_ms;
+    uint32_t sleep_ms;
+
+    memcpy(stats, &g_stats, sizeof(*stats));
+    sleep_ms = stats->residency_ms[POWER_STATE_LIGHT] + stats->residency_ms[POWER_STATE_DEEP];
+    stats->residency_ms[POWER_STATE_ACTIVE] = (total_ms > sleep_ms) ? total_ms - sleep_ms : 0;
+}
+
+/***********************************************************************
+* 函数名称: power_mgr_print_stats
+* 说    明: 打印各功耗状态驻留时间与否决统计
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void power_mgr_print_stats(void)
+{
+    power_stats_t stats;
+    uint32_t total_ms;
+
+    power_mgr_get_stats(&stats);
+    total_ms = stats.residency_ms[POWER_STATE_ACTIVE] + stats.residency_ms[POWER_STATE_LIGHT] +
+               stats.residency_ms[POWER_STATE_DEEP];
+    printf("[power] active=%u light=%u deep=%u s sleep=%u%% entries light=%u deep=%u early=%u short=%u\n",
+           (unsigned)(stats.residency_ms[POWER_STATE_ACTIVE] / 1000),
+           (unsigned)(stats.residency_ms[POWER_STATE_LIGHT] / 1000),
+           (unsigned)(stats.residency_ms[POWER_STATE_DEEP] / 1000),
+           (unsigned)(total_ms ? (uint64_t)(total_ms - stats.residency_ms[POWER_STATE_ACTIVE]) * 100 / total_ms : 0),
+           (unsigned)stats.entries[POWER_STATE_LIGHT], (unsigned)stats.entries[POWER_STATE_DEEP],
+           (unsigned)stats.early_wakes, (unsigned)stats.short_idle);
+    printf("[power] deep vetoes gps=%u fall=%u cooling=%u\n", (unsigned)stats.vetoes[POWER_VETO_GPS_UART],
+           (unsigned)stats.vetoes[POWER_VETO_FALL_BUTTON], (unsigned)stats.vetoes[POWER_VETO_COOLING]);
+}
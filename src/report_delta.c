@@ -0,0 +1,134 @@
+#include <string.h>
+#include <math.h>
+#include "report_delta.h"
+
+static report_delta_stats_t g_stats;
+
+/***********************************************************************
+* 函数名称: report_delta_value
+* 说    明: 取数值属性的当前值
+* 参    数: kv：属性
+* 返 回 值: 数值
+************************************************************************/
+static double report_delta_value(const oc_mqtt_profile_kv_t *kv)
+{
+    switch (kv->type) {
+        case EN_OC_MQTT_PROFILE_VALUE_INT:
+            return (double)*(int *)kv->value;
+        case EN_OC_MQTT_PROFILE_VALUE_LONG:
+            return (double)*(long *)kv->value;
+        case EN_OC_MQTT_PROFILE_VALUE_FLOAT:
+            return *(double *)kv->value;
+        case EN_OC_MQTT_PROFILE_VALUE_E7:
+            return (double)*(int32_t *)kv->value;
+        default:
+            return 0.0;
+    }
+}
+
+/***********************************************************************
+* 函数名称: report_delta_changed
+* 说    明: 判断属性相对上次上报是否超出死区
+* 参    数: p：属性配置与状态
+*           kv：属性当前值
+* 返 回 值: 1 超出，0 未超出
+************************************************************************/
+static int report_delta_changed(const report_delta_t *p, const oc_mqtt_profile_kv_t *kv)
+{
+    if (kv->type == EN_OC_MQTT_PROFILE_VALUE_STRING) {
+        return strncmp(p->last_str, (const char *)kv->value, REPORT_DELTA_STR_LEN - 1) != 0;
+    }
+    double band = p->rel_band * fabs(p->last);
+    if (band < p->abs_band) {
+        band = p->abs_band;
+    }
+    return fabs(report_delta_value(kv) - p->last) > band;
+}
+
+/***********************************************************************
+* 函数名称: report_delta_select
+* 说    明: 挑出需要上报的属性并串成 oc_mqtt_profile_kv_t 链表。
+*           首次出现、超出死区、静默超时或要求全量时选中；
+*           value 为 NULL 的属性本次不存在，直接跳过
+* 参    数: props：属性配置与状态，与 kv 一一对应
+*           kv：属性当前值，key / type / value 由调用方填写
+*           count：属性个数
+*           now_ms：当前时间戳
+*           full：非 0 表示全量快照，所有存在的属性都上报
+* 返 回 值: 链表头，没有需要上报的属性时返回 NULL
+************************************************************************/
+oc_mqtt_profile_kv_t *report_delta_select(report_delta_t *props, oc_mqtt_profile_kv_t *kv, int count,
+                                          uint32_t now_ms, int full)
+{
+    oc_mqtt_profile_kv_t *head = NULL;
+    oc_mqtt_profile_kv_t *tail = NULL;
+
+    for (int i = 0; i < count; i++) {
+        report_delta_t *p = &props[i];
+        p->pending = 0;
+        kv[i].nxt = NULL;
+        if (kv[i].value == NULL) {
+            continue;
+        }
+        if (!full && p->sent && now_ms - p->last_ms < p->max_silence_ms && !report_delta_changed(p, &kv[i])) {
+            g_stats.props_suppressed++;
+            continue;
+        }
+        p->pending = 1;
+        if (tail == NULL) {
+            head = &kv[i];
+        } else {
+            tail->nxt = &kv[i];
+        }
+        tail = &kv[i];
+    }
+
+    if (head == NULL) {
+        g_stats.reports_skipped++;
+    } else {
+        g_stats.reports++;
+        g_stats.full_reports += (full != 0);
+    }
+    return head;
+}
+
+/***********************************************************************
+* 函数名称: report_delta_commit
+* 说    明: 上报成功后记录本次选中属性的取值，作为之后比较的基准；
+*           上报失败时不调用，变化会在下一次重新选中
+* 参    数: props：属性配置与状态
+*           kv：本次上报的属性
+*           count：属性个数
+*           now_ms：当前时间戳
+* 返 回 值: 无
+************************************************************************/
+void report_delta_commit(report_delta_t *props, const oc_mqtt_profile_kv_t *kv, int count, uint32_t now_ms)
+{
+    for (int i = 0; i < count; i++) {
+        report_delta_t *p = &props[i];
+        if (!p->pending) {
+            continue;
+        }
+        p->pending = 0;
+        p->sent = 1;
+        p->last_ms = now_ms;
+        if (kv[i].type == EN_OC_MQTT_PROFILE_VALUE_STRING) {
+            strncpy(p->last_str, (const char *)kv[i].value, REPORT_DELTA_STR_LEN - 1);
+            p->last_str[REPORT_DELTA_STR_LEN - 1] = '\0';
+        } else {
+            p->last = report_delta_value(&kv[i]);
+        }
+        g_stats.props_sent++;
+    }
+}
+
+/***********************************************************************
+* 函数名称: report_delta_get_stats
+* 说    明: 获取变化检测统计
+* 参    数: stats：输出
+* 返 回 值: 无
+************************************************************************/
+void report_delta_get_stats(report_delta_stats_t *stats)
+{
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
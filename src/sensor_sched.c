@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "sensor_sched.h"
+
+/***********************************************************************
+* 结构体名称: sensor_job_t
+* 说    明: 作业表项，deadline 为下一次计划执行时刻（hi_get_milli_seconds 时基）
+************************************************************************/
+typedef struct
+{
+    sensor_job_fn_t fn;
+    void *arg;
+    uint32_t deadline;
+    sensor_job_stats_t stats;
+} sensor_job_t;
+
+static sensor_job_t g_jobs[SENSOR_SCHED_MAX_JOBS];
+static int g_job_count = 0;
+static osMutexId_t g_sched_mutex = NULL;
+static volatile uint32_t g_next_deadline;   // 最早的截止时刻，持锁写入，空闲回调中无锁读取
+
+/***********************************************************************
+* 函数名称: sensor_sched_add
+* 说    明: 注册周期作业，须在 sensor_sched_run 之前调用
+* 参    数: name：作业名，用于统计输出
+*           period_ms：执行周期
+*           phase_ms：首次执行相对当前时刻的偏移，用于错开各作业
+*           fn：作业函数，在调度任务中执行，不应阻塞
+*           arg：作业参数
+* 返 回 值: 作业编号，失败返回 -1
+************************************************************************/
+int sensor_sched_add(const char *name, uint32_t period_ms, uint32_t phase_ms, sensor_job_fn_t fn, void *arg)
+{
+    sensor_job_t *job;
+
+    if (g_sched_mutex == NULL) {
+        g_sched_mutex = osMutexNew(NULL);
+        if (g_sched_mutex == NULL) {
+            printf("[sched] Failed to create mutex!\n");
+            return -1;
+        }
+    }
+    if (g_job_count >= SENSOR_SCHED_MAX_JOBS || period_ms == 0 || fn == NULL) {
+        return -1;
+    }
+    job = &g_jobs[g_job_count];
+    memset(job, 0, sizeof(*job));
+    job->fn = fn;
+    job->arg = arg;
+    job->deadline = hi_get_milli_seconds() + phase_ms;
+    job->stats.name = name;
+    job->stats.period_ms = period_ms;
+    if (g_job_count == 0 || (int32_t)(job->deadline - g_next_deadline) < 0) {
+        g_next_deadline = job->deadline;
+    }
+    return g_job_count++;
+}
+
+/***********************************************************************
+* 函数名称: sensor_sched_set_period
+* 说    明: 运行中修改作业周期，可在其他任务中调用；周期缩短时下一次执行相应提前
+* 参    数: id：作业编号
+*           period_ms：新周期
+* 返 回 值: 0 成功，-1 参数错误
+************************************************************************/
+int sensor_sched_set_period(int id, uint32_t period_ms)
+{
+    uint32_t now_ms = hi_get_milli_seconds();
+
+    if (id < 0 || id >= g_job_count || period_ms == 0) {
+        return -1;
+    }
+    osMutexAcquire(g_sched_mutex, osWaitForever);
+    sensor_job_t *job = &g_jobs[id];
+    job->stats.period_ms = period_ms;
+    if ((int32_t)(job->deadline - (now_ms + period_ms)) > 0) {
+        job->deadline = now_ms + period_ms;
+        if ((int32_t)(job->deadline - g_next_deadline) < 0) {
+            g_next_deadline = job->deadline;
+        }
+    }
+    osMutexRelease(g_sched_mutex);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: sensor_sched_next_deadline
+* 说    明: 获取最早的下一次计划执行时刻。不加锁，可在空闲任务的睡眠检查中调用；
+*           作业执行期间返回的时刻已过去
+* 参    数: 无
+* 返 回 值: 时刻（hi_get_milli_seconds 时基），没有作业时返回当前时刻
+************************************************************************/
+uint32_t sensor_sched_next_deadline(void)
+{
+    if (g_job_count == 0) {
+        return hi_get_milli_seconds();
+    }
+    return g_next_deadline;
+}
+
+/***********************************************************************
+* 函数名称: sensor_sched_run
+* 说    明: 截止时刻最早优先的调度循环，不返回。没有到期作业时按最近的截止时刻睡眠；
+*           作业执行后按周期推进截止时刻，已错过的整周期计入 overruns 并跳过，
+*           不会为追赶进度而连续补跑
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void sensor_sched_run(void)
+{
+    uint32_t tick_freq = osKernelGetTickFreq();
+
+    while (1) {
+        uint32_t now_ms = hi_get_milli_seconds();
+        sensor_job_t *job = NULL;
+        int32_t wait_ms = 0;
+
+        osMutexAcquire(g_sched_mutex, osWaitForever);
+        for (int i = 0; i < g_job_count; i++) {
+            if (job == NULL || (int32_t)(g_jobs[i].deadline - job->deadline) < 0) {
+                job = &g_jobs[i];
+            }
+        }
+        if (job != NULL) {
+            wait_ms = (int32_t)(job->deadline - now_ms);
+            g_next_deadline = job->deadline;
+        }
+        osMutexRelease(g_sched_mutex);
+
+        if (job == NULL) {
+            osDelay(tick_freq);
+            continue;
+        }
+        if (wait_ms > 0) {
+            // 向上取整到系统节拍，至少睡眠一个节拍
+            uint32_t ticks = ((uint32_t)wait_ms * tick_freq + 999) / 1000;
+            osDelay(ticks > 0 ? ticks : 1);
+            continue;
+        }
+
+        uint32_t late = (uint32_t)(-wait_ms);
+        job->fn(now_ms, job->arg);
+        uint32_t end_ms = hi_get_milli_seconds();
+
+        osMutexAcquire(g_sched_mutex, osWaitForever);
+        sensor_job_stats_t *stats = &job->stats;
+        stats->runs++;
+        stats->jitter_total_ms += late;
+        if (late > stats->jitter_max_ms) {
+            stats->jitter_max_ms = late;
+        }
+        if (end_ms - now_ms > stats->run_max_ms) {
+            stats->run_max_ms = end_ms - now_ms;
+        }
+        job->deadline += stats->period_ms;
+        if ((int32_t)(end_ms - job->deadline) >= 0) {
+            uint32_t missed = (end_ms - job->deadline) / stats->period_ms + 1;
+            stats->overruns += missed;
+            job->deadline += missed * stats->period_ms;
+        }
+        osMutexRelease(g_sched_mutex);
+    }
+}
+
+/***********************************************************************
+* 函数名称: sensor_sched_get_stats
+* 说    明: 获取作业运行统计
+* 参    数: id：作业编号
+*           stats：输出
+* 返 回 值: 0 成功，-1 参数错误
+************************************************************************/
+int sensor_sched_get_stats(int id, sensor_job_stats_t *stats)
+{
+    if (id < 0 || id >= g_job_count) {
+        return -1;
+    }
+    osMutexAcquire(g_sched_mutex, osWaitForever);
+    *stats = g_jobs[id].stats;
+    osMutexRelease(g_sched_mutex);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: sensor_sched_print_stats
+* 说    明: 打印所有作业的运行统计
+* 参    数: 无
+* 返 回 值: 无
+************************************************************************/
+void sensor_sched_print_stats(void)
+{
+    sensor_job_stats_t stats;
+
+    for (int i = 0; i < g_job_count; i++) {
+        if (sensor_sched_get_stats(i, &stats) != 0 || stats.runs == 0) {
+            continue;
+        }
+        printf("[sched] %s period=%u n=%u jitter avg=%u max=%u ms run max=%u ms overrun=%u\n", stats.name,
+               (unsigned)stats.period_ms, (unsigned)stats.runs, (unsigned)(stats.jitter_total_ms / stats.runs),
+               (unsigned)stats.jitter_max_ms, (unsigned)stats.run_max_ms, (unsigned)stats.overruns);
+    }
+}
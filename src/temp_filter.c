@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include "temp_filter.h"
+
+/***********************************************************************
+* 函数名称: temp_filter_init
+* 说    明: 复位体温滤波器，等待下一帧有效数据重新初始化
+* 参    数: f：滤波器状态
+* 返 回 值: 无
+************************************************************************/
+void temp_filter_init(temp_filter_t *f)
+{
+    memset(f, 0, sizeof(*f));
+}
+
+/***********************************************************************
+* 函数名称: temp_filter_update
+* 说    明: 用一次 MAX30205 读数更新 alpha-beta 滤波器
+*           读数超出有效范围（含读取失败返回的 -1）时丢弃，不影响状态
+* 参    数: f：滤波器状态
+*           measured：本次测得的温度（°C）
+*           now_ms：当前时间戳（毫秒）
+* 返 回 值: 0 表示已更新，-1 表示读数无效被丢弃
+************************************************************************/
+int temp_filter_update(temp_filter_t *f, float measured, uint32_t now_ms)
+{
+    if (measured < TEMP_FILTER_MIN_VALID || measured > TEMP_FILTER_MAX_VALID) {
+        return -1;
+    }
+
+    uint32_t dt_ms = now_ms - f->last_ms;
+    if (!f->initialized || dt_ms > TEMP_FILTER_MAX_DT_MS) {
+        f->temp = measured;
+        f->rate = 0.0f;
+        f->last_ms = now_ms;
+        f->initialized = 1;
+        return 0;
+    }
+    if (dt_ms == 0) {
+        return 0;
+    }
+
+    float dt = dt_ms / 1000.0f;
+    float predicted = f->temp + f->rate * dt;
+    float residual = measured - predicted;
+
+    f->temp = predicted + TEMP_FILTER_ALPHA * residual;
+    f->rate = f->rate + (TEMP_FILTER_BETA / dt) * residual;
+    f->last_ms = now_ms;
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: temp_filter_rate_per_min
+* 说    明: 获取温度变化率
+* 参    数: f：滤波器状态
+* 返 回 值: 温度变化率（°C/min）
+************************************************************************/
+float temp_filter_rate_per_min(const temp_filter_t *f)
+{
+    return f->rate * 60.0f;
+}
+
+/***********************************************************************
+* 函数名称: temp_filter_predict
+* 说    明: 按当前温度和变化率外推 horizon_s 秒后的温度
+* 参    数: f：滤波器状态
+*           horizon_s：预测时长（秒）
+* 返 回 值: 预测温度（°C）
+************************************************************************/
+float temp_filter_predict(const temp_filter_t *f, uint32_t horizon_s)
+{
+    return f->temp + f->rate * (float)horizon_s;
+}
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "lwip/sntp.h"
+#include "time_service.h"
+
+/*
+ * UTC 时间以“某一单调时刻对应的 UTC 毫秒数”表示：
+ * utc(now) = g_base_utc_ms + (now - g_base_mono_ms)，单调时钟为 hi_get_milli_seconds()。
+ * GPS（RMC）每秒给出一次样本，偏差大时跳变，偏差小时每次只修正一部分，
+ * 避免相邻时间戳因 NMEA 输出延迟抖动而来回跳动。
+ */
+static uint64_t g_base_utc_ms;
+static uint32_t g_base_mono_ms;
+static time_source_t g_source = TIME_SRC_NONE;
+static uint32_t g_last_gps_ms;
+static uint32_t g_next_sntp_ms;
+static char g_sntp_server[64] = TIME_SNTP_SERVER;
+static osMutexId_t g_time_mutex = NULL;
+static osEventFlagsId_t g_sntp_event = NULL;
+
+#define TIME_SNTP_FLAG_NOW      0x0001U     // 服务器已修改，立即校时
+
+/***********************************************************************
+* 函数名称: time_days_from_civil
+* 说    明: 公历日期转换为 1970-01-01 起的天数（整数算法）
+* 参    数: y / m / d：年、月、日
+* 返 回 值: 天数
+************************************************************************/
+static int32_t time_days_from_civil(int32_t y, uint32_t m, uint32_t d)
+{
+    y -= (m <= 2);
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+/***********************************************************************
+* 函数名称: time_civil_from_days
+* 说    明: 1970-01-01 起的天数转换为公历日期
+* 参    数: z：天数
+*           y / m / d：输出年、月、日
+* 返 回 值: 无
+************************************************************************/
+static void time_civil_from_days(int32_t z, int32_t *y, uint32_t *m, uint32_t *d)
+{
+    z += 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int32_t)yoe + era * 400 + (*m <= 2);
+}
+
+/***********************************************************************
+* 函数名称: time_service_init
+* 说    明: 初始化时间服务
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int time_service_init(void)
+{
+    if (g_time_mutex != NULL) {
+        return 0;
+    }
+    g_time_mutex = osMutexNew(NULL);
+    if (g_time_mutex == NULL) {
+        printf("[time] Failed to create mutex!\n");
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: time_service_sync
+* 说    明: 用一个 UTC 样本校准时钟。SNTP 样本在最近有 GPS 授时时忽略；
+*           偏差超过 TIME_STEP_MS 直接跳变，否则按 1/2^TIME_SLEW_SHIFT 逐步修正
+* 参    数: utc_ms：样本 UTC 毫秒数（1970 起）
+*           mono_ms：样本对应的单调时钟
+*           src：时间来源
+* 返 回 值: 无
+************************************************************************/
+void time_service_sync(uint64_t utc_ms, uint32_t mono_ms, time_source_t src)
+{
+    if (g_time_mutex == NULL) {
+        return;
+    }
+    osMutexAcquire(g_time_mutex, osWaitForever);
+    if (src == TIME_SRC_SNTP && g_source == TIME_SRC_GPS && mono_ms - g_last_gps_ms < TIME_GPS_HOLD_MS) {
+        osMutexRelease(g_time_mutex);
+        return;
+    }
+
+    uint64_t local = g_base_utc_ms + (uint32_t)(mono_ms - g_base_mono_ms);
+    int64_t err = (int64_t)(utc_ms - local);
+    if (g_source == TIME_SRC_NONE || err > TIME_STEP_MS || err < -TIME_STEP_MS) {
+        if (g_source != TIME_SRC_NONE) {
+            printf("[time] step %lld ms (src %d)\n", (long long)err, src);
+        }
+        g_base_utc_ms = utc_ms;
+    } else {
+        g_base_utc_ms = local + err / (1 << TIME_SLEW_SHIFT);
+    }
+    g_base_mono_ms = mono_ms;
+    g_source = src;
+    if (src == TIME_SRC_GPS) {
+        g_last_gps_ms = mono_ms;
+    }
+    osMutexRelease(g_time_mutex);
+}
+
+/***********************************************************************
+* 函数名称: time_service_sync_gps
+* 说    明: 用 RMC 的 UTC 日期时间校准时钟
+* 参    数: utc_date：ddmmyy
+*           utc_time：hhmmss
+*           mono_ms：收到该语句时的单调时钟
+* 返 回 值: 无
+************************************************************************/
+void time_service_sync_gps(uint32_t utc_date, uint32_t utc_time, uint32_t mono_ms)
+{
+    uint32_t day = utc_date / 10000;
+    uint32_t month = utc_date / 100 % 100;
+
+    if (day == 0 || month == 0 || month > 12) {
+        return;
+    }
+    int32_t days = time_days_from_civil(2000 + (int32_t)(utc_date % 100), month, day);
+    uint32_t secs = (utc_time / 10000) * 3600 + (utc_time / 100 % 100) * 60 + utc_time % 100;
+    time_service_sync(((uint64_t)days * 86400 + secs) * 1000, mono_ms, TIME_SRC_GPS);
+}
+
+/***********************************************************************
+* 函数名称: time_service_set_sntp_server
+* 说    明: 设置 SNTP 服务器（域名或 IP），并唤醒校时任务立即校时
+* 参    数: server：服务器地址
+* 返 回 值: 无
+************************************************************************/
+void time_service_set_sntp_server(const char *server)
+{
+    if (g_time_mutex != NULL) {
+        osMutexAcquire(g_time_mutex, osWaitForever);
+    }
+    strncpy(g_sntp_server, server, sizeof(g_sntp_server) - 1);
+    g_sntp_server[sizeof(g_sntp_server) - 1] = '\0';
+    g_next_sntp_ms = 0;
+    if (g_time_mutex != NULL) {
+        osMutexRelease(g_time_mutex);
+    }
+    if (g_sntp_event != NULL) {
+        osEventFlagsSet(g_sntp_event, TIME_SNTP_FLAG_NOW);
+    }
+}
+
+/***********************************************************************
+* 函数名称: time_sntp_poll
+* 说    明: 最近没有 GPS 授时且到达校时间隔时，向 SNTP 服务器请求时间
+*           （阻塞直到应答或 lwIP 超时，只在校时任务中调用）
+* 参    数: now_ms：当前单调时钟
+* 返 回 值: 1 本次完成 SNTP 校时，0 未请求或失败
+************************************************************************/
+static int time_sntp_poll(uint32_t now_ms)
+{
+    char server[sizeof(g_sntp_server)];
+    char *servers[1] = { server };
+    struct timeval tv;
+
+    if (g_source == TIME_SRC_GPS && now_ms - g_last_gps_ms < TIME_GPS_HOLD_MS) {
+        return 0;
+    }
+    if (g_next_sntp_ms != 0 && (int32_t)(now_ms - g_next_sntp_ms) < 0) {
+        return 0;
+    }
+    osMutexAcquire(g_time_mutex, osWaitForever);
+    memcpy(server, g_sntp_server, sizeof(server));
+    osMutexRelease(g_time_mutex);
+    if (lwip_sntp_start(1, servers, &tv) != 0) {
+        printf("[time] SNTP %s failed\n", server);
+        g_next_sntp_ms = hi_get_milli_seconds() + TIME_SNTP_RETRY_MS;
+        return 0;
+    }
+    // 样本对应的单调时刻取应答返回时，请求期间的阻塞时间不计入偏差
+    time_service_sync((uint64_t)tv.tv_sec * 1000 + (uint64_t)tv.tv_usec / 1000, hi_get_milli_seconds(),
+                      TIME_SRC_SNTP);
+    g_next_sntp_ms = hi_get_milli_seconds() + TIME_SNTP_INTERVAL_MS;
+    return 1;
+}
+
+/***********************************************************************
+* 函数名称: time_sntp_task
+* 说    明: SNTP 校时任务。优先级低于主任务，lwip_sntp_start 阻塞期间
+*           主任务照常分发消息、上报与重连
+* 参    数: arg：未使用
+* 返 回 值: 无
+************************************************************************/
+static void time_sntp_task(void *arg)
+{
+    uint32_t ticks = (uint32_t)(((uint64_t)TIME_SNTP_CHECK_MS * osKernelGetTickFreq() + 999) / 1000);
+
+    (void)arg;
+    while (1) {
+        (void)time_sntp_poll(hi_get_milli_seconds());
+        (void)osEventFlagsWait(g_sntp_event, TIME_SNTP_FLAG_NOW, osFlagsWaitAny, ticks);
+    }
+}
+
+/***********************************************************************
+* 函数名称: time_service_start_sntp
+* 说    明: 创建 SNTP 校时任务，需在 time_service_init 之后、连上网络后调用
+* 参    数: 无
+* 返 回 值: 0 成功，-1 失败
+************************************************************************/
+int time_service_start_sntp(void)
+{
+    osThreadAttr_t attr;
+
+    if (g_time_mutex == NULL) {
+        return -1;
+    }
+    if (g_sntp_event != NULL) {
+        return 0;
+    }
+    g_sntp_event = osEventFlagsNew(NULL);
+    if (g_sntp_event == NULL) {
+        printf("[time] Failed to create sntp event!\n");
+        return -1;
+    }
+
+    attr.name = "time_sntp";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = TIME_SNTP_TASK_STACK;
+    attr.priority = TIME_SNTP_TASK_PRIO;
+    if (osThreadNew((osThreadFunc_t)time_sntp_task, NULL, &attr) == NULL) {
+        printf("[time] Failed to create time_sntp!\n");
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: time_service_utc_ms
+* 说    明: 把单调时钟换算为 UTC 毫秒数
+* 参    数: mono_ms：单调时钟（可以是过去某个采样时刻）
+*           utc_ms：输出
+* 返 回 值: 0 成功，-1 尚未校时
+************************************************************************/
+int time_service_utc_ms(uint32_t mono_ms, uint64_t *utc_ms)
+{
+    if (g_time_mutex == NULL || g_source == TIME_SRC_NONE) {
+        return -1;
+    }
+    osMutexAcquire(g_time_mutex, osWaitForever);
+    *utc_ms = g_base_utc_ms + (int64_t)(int32_t)(mono_ms - g_base_mono_ms);
+    osMutexRelease(g_time_mutex);
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: time_service_format
+* 说    明: 生成平台 event_time 格式的时间戳 yyyyMMddTHHmmssZ
+* 参    数: mono_ms：数据采样时的单调时钟
+*           buf：输出缓存，至少 TIME_EVENT_TIME_LEN 字节
+*           len：缓存大小
+* 返 回 值: 0 成功，-1 尚未校时（调用方应让平台按到达时间打戳）
+************************************************************************/
+int time_service_format(uint32_t mono_ms, char *buf, int len)
+{
+    uint64_t utc_ms;
+    int32_t year;
+    uint32_t month;
+    uint32_t day;
+
+    if (len < TIME_EVENT_TIME_LEN || time_service_utc_ms(mono_ms, &utc_ms) != 0) {
+        return -1;
+    }
+    uint32_t secs = (uint32_t)(utc_ms / 1000);
+    uint32_t sod = secs % 86400;
+    time_civil_from_days((int32_t)(secs / 86400), &year, &month, &day);
+    snprintf(buf, (size_t)len, "%04d%02u%02uT%02u%02u%02uZ", (int)year, (unsigned)month, (unsigned)day,
+             (unsigned)(sod / 3600), (unsigned)(sod / 60 % 60), (unsigned)(sod % 60));
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: time_service_utc_nmea
+* 说    明: 把单调时钟换算为 NMEA 格式的 UTC 日期与时间
+* 参    数: mono_ms：单调时钟
+*           utc_date：输出 ddmmyy
+*           utc_time：输出 hhmmss
+* 返 回 值: 0 成功，-1 尚未校时
+************************************************************************/
+int time_service_utc_nmea(uint32_t mono_ms, uint32_t *utc_date, uint32_t *utc_time)
+{
+    uint64_t utc_ms;
+    int32_t year;
+    uint32_t month;
+    uint32_t day;
+
+    if (time_service_utc_ms(mono_ms, &utc_ms) != 0) {
+        return -1;
+    }
+    uint32_t secs = (uint32_t)(utc_ms / 1000);
+    uint32_t sod = secs % 86400;
+    time_civil_from_days((int32_t)(secs / 86400), &year, &month, &day);
+    *utc_date = day * 10000 + month * 100 + (uint32_t)(year % 100);
+    *utc_time = (sod / 3600) * 10000 + (sod / 60 % 60) * 100 + sod % 60;
+    return 0;
+}
+
+/***********************************************************************
+* 函数名称: time_service_source
+* 说    明: 获取当前时间来源
+* 参    数: 无
+* 返 回 值: 时间来源
+************************************************************************/
+time_source_t time_service_source(void)
+{
+    return g_source;
+}
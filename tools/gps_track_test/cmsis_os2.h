@@ -0,0 +1,34 @@
+/*
+ * 主机测试用的最小 CMSIS-RTOS2 接口：单线程运行，互斥量为空操作
+ */
+#ifndef __CMSIS_OS2_H__
+#define __CMSIS_OS2_H__
+
+#include <stdint.h>
+
+typedef void *osMutexId_t;
+typedef int osStatus_t;
+
+#define osOK            0
+#define osWaitForever   0xFFFFFFFFU
+
+static inline osMutexId_t osMutexNew(const void *attr)
+{
+    (void)attr;
+    return (osMutexId_t)1;
+}
+
+static inline osStatus_t osMutexAcquire(osMutexId_t mutex, uint32_t timeout)
+{
+    (void)mutex;
+    (void)timeout;
+    return osOK;
+}
+
+static inline osStatus_t osMutexRelease(osMutexId_t mutex)
+{
+    (void)mutex;
+    return osOK;
+}
+
+#endif
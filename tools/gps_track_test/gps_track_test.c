@@ -0,0 +1,218 @@
+/*
+ * 轨迹压缩主机测试：解码 gps_track_encode 的输出，检查每个点都能在输入中按时间和坐标
+ * 找到，且相邻段首尾相接。覆盖正常上传、上传失败重编码、以及长时间不上传
+ * 导致段满丢点后再确认上传并继续记录的情况。
+ *
+ * 编译运行（在本目录下）：
+ *   gcc -O2 -std=gnu99 -I. -I../../include gps_track_test.c ../../src/gps_track.c -lm -o gps_track_test
+ *   ./gps_track_test
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "gps_track.h"
+
+#define TEST_POINTS_MAX     2048
+
+typedef struct
+{
+    int32_t lat_e6;
+    int32_t lon_e6;
+    uint32_t t_s;
+} test_point_t;
+
+static test_point_t g_input[TEST_POINTS_MAX];
+static int g_input_count = 0;
+static int g_failures = 0;
+static int32_t g_lat_e7 = 300000000;
+static int32_t g_lon_e7 = 1200000000;
+static uint32_t g_now_ms = 0;
+static test_point_t g_prev_end;         // 上一段的最后一点
+static int g_has_prev_end = 0;
+
+#define TEST_CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("[test] FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        g_failures++; \
+    } \
+} while (0)
+
+static int32_t test_e6(int32_t e7)
+{
+    return (e7 >= 0) ? (e7 + 5) / 10 : (e7 - 5) / 10;
+}
+
+/***********************************************************************
+* 函数名称: test_add
+* 说    明: 加入 count 个点，每秒一个，横向交替偏移约 100 米，保证每个点都被保留
+* 参    数: count：点数
+* 返 回 值: 无
+************************************************************************/
+static void test_add(int count)
+{
+    for (int i = 0; i < count && g_input_count < TEST_POINTS_MAX; i++) {
+        g_now_ms += 1000;
+        g_lat_e7 += 2000;
+        g_lon_e7 += (g_input_count & 1) ? 9000 : -9000;
+        g_input[g_input_count].lat_e6 = test_e6(g_lat_e7);
+        g_input[g_input_count].lon_e6 = test_e6(g_lon_e7);
+        g_input[g_input_count].t_s = g_now_ms / 1000;
+        g_input_count++;
+        gps_track_add(g_lat_e7, g_lon_e7, g_now_ms, 10125, 0);
+    }
+}
+
+static const test_point_t *test_find(int32_t lat_e6, int32_t lon_e6)
+{
+    for (int i = 0; i < g_input_count; i++) {
+        if (g_input[i].lat_e6 == lat_e6 && g_input[i].lon_e6 == lon_e6) {
+            return &g_input[i];
+        }
+    }
+    return NULL;
+}
+
+static int test_b64_value(char c)
+{
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const char *p = strchr(table, c);
+
+    return (p != NULL && c != '\0') ? (int)(p - table) : -1;
+}
+
+static uint32_t test_varint(const uint8_t *buf, int len, int *pos)
+{
+    uint32_t v = 0;
+    int shift = 0;
+
+    while (*pos < len) {
+        uint8_t b = buf[(*pos)++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return v;
+}
+
+static int32_t test_zigzag(const uint8_t *buf, int len, int *pos)
+{
+    uint32_t u = test_varint(buf, len, pos);
+
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+/***********************************************************************
+* 函数名称: test_check_segment
+* 说    明: 解码一个轨迹段并逐点与输入比对
+* 参    数: b64：gps_track_encode 的输出
+*           name：用例名
+* 返 回 值: 段内点数
+************************************************************************/
+static int test_check_segment(const char *b64, const char *name)
+{
+    uint8_t seg[GPS_TRACK_SEG_BYTES + 3];
+    int len = 0;
+    int pos = 1;
+    int points = 1;
+
+    for (int i = 0; b64[i] != '\0'; i += 4) {
+        uint32_t v = 0;
+        int pad = 0;
+        for (int k = 0; k < 4; k++) {
+            int d = test_b64_value(b64[i + k]);
+            v <<= 6;
+            if (d < 0) {
+                pad++;
+            } else {
+                v |= (uint32_t)d;
+            }
+        }
+        seg[len++] = (uint8_t)(v >> 16);
+        if (pad < 2) {
+            seg[len++] = (uint8_t)(v >> 8);
+        }
+        if (pad < 1) {
+            seg[len++] = (uint8_t)v;
+        }
+    }
+    TEST_CHECK(len > 0 && seg[0] == 1, "%s: bad version", name);
+
+    (void)test_varint(seg, len, &pos);
+    (void)test_varint(seg, len, &pos);
+    int32_t lat = test_zigzag(seg, len, &pos);
+    int32_t lon = test_zigzag(seg, len, &pos);
+    const test_point_t *start = test_find(lat, lon);
+    TEST_CHECK(start != NULL, "%s: header point %d,%d was never added", name, (int)lat, (int)lon);
+    if (start == NULL) {
+        return 0;
+    }
+    if (g_has_prev_end) {
+        TEST_CHECK(start->t_s == g_prev_end.t_s, "%s: segment does not start where the last one ended", name);
+    }
+
+    uint32_t t_s = start->t_s;
+    const test_point_t *p = start;
+    while (pos < len) {
+        t_s += test_varint(seg, len, &pos);
+        lat += test_zigzag(seg, len, &pos);
+        lon += test_zigzag(seg, len, &pos);
+        p = test_find(lat, lon);
+        TEST_CHECK(p != NULL && p->t_s == t_s, "%s: point %d decodes to %d,%d at %u, not an input point",
+                   name, points, (int)lat, (int)lon, (unsigned)t_s);
+        if (p == NULL) {
+            return points;
+        }
+        points++;
+    }
+    g_prev_end = *p;
+    return points;
+}
+
+int main(void)
+{
+    static char buf[GPS_TRACK_B64_SIZE];
+    gps_track_stats_t stats;
+    int points;
+
+    gps_track_init();
+
+    // 正常上传
+    test_add(10);
+    TEST_CHECK(gps_track_encode(buf, sizeof(buf), g_now_ms) > 0, "normal: nothing encoded");
+    points = test_check_segment(buf, "normal");
+    gps_track_commit(g_now_ms);
+    g_has_prev_end = 1;
+    printf("[test] normal: %d points\n", points);
+
+    // 上传失败：不确认，下次编码包含旧点与新点
+    test_add(5);
+    TEST_CHECK(gps_track_encode(buf, sizeof(buf), g_now_ms) > 0, "retry: nothing encoded");
+    test_add(5);
+    TEST_CHECK(gps_track_encode(buf, sizeof(buf), g_now_ms) > 0, "retry: nothing encoded");
+    points = test_check_segment(buf, "retry");
+    gps_track_commit(g_now_ms);
+    printf("[test] retry: %d points\n", points);
+
+    // 长时间离线：段满丢点，随后上传确认并继续记录
+    test_add(200);
+    gps_track_get_stats(&stats);
+    TEST_CHECK(stats.points_dropped > 0, "overflow: no point dropped");
+    TEST_CHECK(gps_track_encode(buf, sizeof(buf), g_now_ms) > 0, "overflow: nothing encoded");
+    points = test_check_segment(buf, "overflow");
+    test_add(3);        // 上传期间新增的点
+    gps_track_commit(g_now_ms);
+    printf("[test] overflow: %d points, %u dropped\n", points, (unsigned)stats.points_dropped);
+
+    test_add(10);
+    TEST_CHECK(gps_track_encode(buf, sizeof(buf), g_now_ms) > 0, "after overflow: nothing encoded");
+    points = test_check_segment(buf, "after overflow");
+    gps_track_commit(g_now_ms);
+    printf("[test] after overflow: %d points\n", points);
+
+    printf("[test] %s\n", (g_failures == 0) ? "PASS" : "FAIL");
+    return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+/*
+ * NMEA 解析器主机端基准：把 NMEA 日志按串口接收任务的块大小反复喂给 nmea_parser，
+ * 统计每秒处理的字节数与语句数，用于比较解析器改动前后的吞吐。
+ *
+ * 编译（在本目录下）：
+ *   gcc -O2 -std=gnu99 -I../../include nmea_bench.c ../../src/nmea_parser.c -o nmea_bench
+ * 运行：
+ *   ./nmea_bench [日志文件，默认 sample.nmea] [重复次数，默认 200] [块大小，默认 64]
+ *
+ * sample.nmea 为 1 Hz 输出的 120 个定位周期（GGA/GSA/GPGSV/GLGSV/RMC/VTG），
+ * 与 gps_config 屏蔽后的语句组合一致。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "nmea_parser.h"
+
+#define BENCH_CHUNK_DEFAULT     64      // 与 GPS_UART_CHUNK_SIZE 一致
+#define BENCH_REPEAT_DEFAULT    200
+
+static uint32_t g_fixes = 0;
+
+static void bench_on_fix(const nmea_fix_t *fix, nmea_sentence_t type, void *arg)
+{
+    (void)fix;
+    (void)type;
+    (void)arg;
+    g_fixes++;
+}
+
+/***********************************************************************
+* 函数名称: bench_load
+* 说    明: 把日志文件整体读入内存，计时范围内不做文件 IO
+* 参    数: path：文件路径
+*           len：输出文件长度
+* 返 回 值: 文件内容，失败返回 NULL
+************************************************************************/
+static uint8_t *bench_load(const char *path, long *len)
+{
+    FILE *fp = fopen(path, "rb");
+    uint8_t *data = NULL;
+
+    if (fp == NULL) {
+        printf("[bench] Failed to open %s!\n", path);
+        return NULL;
+    }
+    if (fseek(fp, 0, SEEK_END) == 0 && (*len = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+        data = (uint8_t *)malloc((size_t)*len);
+        if (data != NULL && fread(data, 1, (size_t)*len, fp) != (size_t)*len) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(fp);
+    if (data == NULL) {
+        printf("[bench] Failed to read %s!\n", path);
+    }
+    return data;
+}
+
+static double bench_now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : "sample.nmea";
+    int repeat = (argc > 2) ? atoi(argv[2]) : BENCH_REPEAT_DEFAULT;
+    int chunk = (argc > 3) ? atoi(argv[3]) : BENCH_CHUNK_DEFAULT;
+    nmea_parser_t parser;
+    uint8_t *data;
+    long len = 0;
+    double start;
+    double elapsed;
+    double total;
+
+    if (repeat <= 0 || chunk <= 0) {
+        printf("usage: %s [file] [repeat] [chunk]\n", argv[0]);
+        return 1;
+    }
+    data = bench_load(path, &len);
+    if (data == NULL) {
+        return 1;
+    }
+
+    nmea_parser_init(&parser, bench_on_fix, NULL);
+    start = bench_now_s();
+    for (int r = 0; r < repeat; r++) {
+        for (long off = 0; off < len; off += chunk) {
+            int n = (len - off > chunk) ? chunk : (int)(len - off);
+            nmea_parser_feed(&parser, data + off, n);
+        }
+    }
+    elapsed = bench_now_s() - start;
+    total = (double)len * repeat;
+
+    printf("[bench] %s: %ld bytes x %d, chunk %d\n", path, len, repeat, chunk);
+    printf("[bench] %.3f s, %.2f MB/s, %.0f sentences/s\n", elapsed, total / elapsed / 1e6,
+           (double)parser.sentences / elapsed);
+    printf("[bench] sentences=%u fixes=%u checksum_errors=%u overflows=%u\n", (unsigned)parser.sentences,
+           (unsigned)g_fixes, (unsigned)parser.checksum_errors, (unsigned)parser.overflows);
+    free(data);
+    return (parser.checksum_errors == 0 && parser.overflows == 0) ? 0 : 1;
+}